@@ -0,0 +1,392 @@
+/**
+ * @file ADS1x15Benchmark.ino
+ * @author Keegan Morrow
+ * @version 0.0.4
+ * @brief Measures throughput, latency and CPU idle time of each read mode
+ * @details Runs every mode at every data rate of the chip and prints one CSV
+ * line per run:
+ *
+ * chip,mode,rate_sps,samples,elapsed_us,samples_per_s,lat_min_us,lat_mean_us,lat_p50_us,lat_p90_us,lat_p99_us,lat_max_us,idle_pct,timeouts
+ *
+ * Latency is the time of one call (one sample, one scan or one bus scan);
+ * for streaming it is the time between two samples. The percentiles come from
+ * a histogram with four buckets per power of two, so they are the upper edge
+ * of a bucket and up to 25% above the exact value. The idle percentage
+ * comes from an idle counter that runs while the library waits, compared to
+ * the same counter with the ADC unused.
+ *
+ * Wiring: ALERT/RDY to rdyPin for the interrupt mode, a second chip with
+ * ADDR to VDD (address index 1) for the multi-device scan; modes without the
+ * hardware are skipped.
+ */
+
+#include <Wire.h>
+#include <ADS1x15.h>
+#include <ADS1x15Bus.h>
+
+// Uncomment to benchmark an ADS1015
+// #define BENCH_ADS1015
+
+const uint8_t rdyPin = 2;
+const uint32_t runMillis = 1000; // target length of one run
+const uint32_t clockHz = 400000;
+
+#ifdef BENCH_ADS1015
+typedef ADS1015 Chip;
+const char *chipName = "ADS1015";
+const ADS1015_DR_t rates[] = {ADS1015_DR_128, ADS1015_DR_250, ADS1015_DR_490, ADS1015_DR_920,
+                              ADS1015_DR_1600, ADS1015_DR_2400, ADS1015_DR_3300};
+const uint16_t rateSps[] = {128, 250, 490, 920, 1600, 2400, 3300};
+#else
+typedef ADS1115 Chip;
+const char *chipName = "ADS1115";
+const ADS1115_DR_t rates[] = {ADS1115_DR_8, ADS1115_DR_16, ADS1115_DR_32, ADS1115_DR_64,
+                              ADS1115_DR_128, ADS1115_DR_250, ADS1115_DR_475, ADS1115_DR_860};
+const uint16_t rateSps[] = {8, 16, 32, 64, 128, 250, 475, 860};
+#endif
+const uint8_t rateCount = sizeof(rateSps) / sizeof(rateSps[0]);
+
+const ADS1x15_MUX_t scanList[] = {SE0, SE1, SE2, SE3};
+const uint8_t scanCount = sizeof(scanList) / sizeof(scanList[0]);
+
+Chip adc;
+Chip adc2;
+ADS1x15Bus bus;
+bool haveSecond = false;
+bool haveRdy = false;
+
+int16_t streamBuffer[32];
+int16_t scanOut[scanCount * 2];
+
+const uint8_t histogramBuckets = 96; // four per power of two, up to about 33 s
+
+volatile uint32_t idleCount = 0;
+uint32_t idlePerMs = 0; // idle counts per ms with the ADC unused
+
+struct Result
+{
+	uint32_t samples;
+	uint32_t elapsed;
+	uint32_t latMin;
+	uint32_t latMax;
+	uint32_t latSum;
+	uint32_t calls;
+	uint32_t idle;
+	uint32_t timeouts;
+	uint16_t histogram[histogramBuckets];
+};
+
+Result result;
+
+/**
+ * @brief One unit of background work, counted to estimate the CPU idle time
+ */
+void idle()
+{
+	idleCount++;
+}
+
+/**
+ * @brief Measure the idle counter rate with the ADC unused
+ */
+void calibrateIdle()
+{
+	idleCount = 0;
+	uint32_t start = millis();
+	while ((millis() - start) < 100) { idle(); }
+	idlePerMs = idleCount / 100;
+}
+
+/**
+ * @brief Clear the result and the counters for a new run
+ */
+void beginRun()
+{
+	result.samples = 0;
+	result.latMin = 0xFFFFFFFFUL;
+	result.latMax = 0;
+	result.latSum = 0;
+	result.calls = 0;
+	result.timeouts = 0;
+	for (uint8_t i = 0; i < histogramBuckets; i++) { result.histogram[i] = 0; }
+	adc.clearTimeout();
+	adc2.clearTimeout();
+	idleCount = 0;
+	result.elapsed = micros();
+}
+
+/**
+ * @brief Find the histogram bucket of a latency
+ * @details Values below 4 us have their own bucket; above that every power of
+ * two is split into four buckets by the two bits below the highest set bit.
+ *
+ * @param latency Duration in us
+ * @return Bucket index
+ */
+uint8_t bucketOf(uint32_t latency)
+{
+	if (latency < 4) { return latency; }
+	uint8_t top = 31;
+	while (!(latency & (1UL << top))) { top--; }
+	uint16_t bucket = (top - 1) * 4 + ((latency >> (top - 2)) & 3);
+	if (bucket >= histogramBuckets) { bucket = histogramBuckets - 1; }
+	return bucket;
+}
+
+/**
+ * @brief Get the largest latency that falls in a histogram bucket
+ *
+ * @param bucket Bucket index
+ * @return Upper edge of the bucket in us
+ */
+uint32_t bucketTop(uint8_t bucket)
+{
+	if (bucket < 4) { return bucket; }
+	uint8_t top = bucket / 4 + 1;
+	uint32_t width = 1UL << (top - 2);
+	return (4 + bucket % 4) * width + width - 1;
+}
+
+/**
+ * @brief Estimate a latency percentile from the histogram
+ *
+ * @param percent Percentile, 1 to 100
+ * @return Upper edge of the bucket holding the percentile, at most lat_max
+ */
+uint32_t percentile(uint8_t percent)
+{
+	if (result.calls == 0) { return 0; }
+	uint32_t target = (result.calls * percent + 99) / 100;
+	uint32_t count = 0;
+	for (uint8_t i = 0; i < histogramBuckets; i++)
+	{
+		count += result.histogram[i];
+		if (count >= target)
+		{
+			uint32_t value = bucketTop(i);
+			return value < result.latMax ? value : result.latMax;
+		}
+	}
+	return result.latMax;
+}
+
+/**
+ * @brief Record the latency of one call
+ *
+ * @param latency Duration in us
+ * @param samples Samples produced by the call
+ */
+void addCall(uint32_t latency, uint8_t samples)
+{
+	if (latency < result.latMin) { result.latMin = latency; }
+	if (latency > result.latMax) { result.latMax = latency; }
+	result.latSum += latency;
+	uint8_t bucket = bucketOf(latency);
+	if (result.histogram[bucket] < 0xFFFF) { result.histogram[bucket]++; }
+	result.calls++;
+	result.samples += samples;
+}
+
+/**
+ * @brief Check if the current run has lasted long enough
+ *
+ * @return True when the run is done
+ */
+bool runDone()
+{
+	return (micros() - result.elapsed) >= runMillis * 1000UL && result.calls >= 4;
+}
+
+/**
+ * @brief Finish a run and print its CSV line
+ *
+ * @param mode Name of the mode
+ * @param sps Nominal data rate
+ */
+void endRun(const char *mode, uint16_t sps)
+{
+	result.elapsed = micros() - result.elapsed;
+	result.idle = idleCount;
+	if (adc.timedOut()) { result.timeouts++; }
+	if (adc2.timedOut()) { result.timeouts++; }
+	if (result.calls == 0) { result.latMin = 0; }
+	float seconds = result.elapsed * 0.000001;
+	float idlePct = 0.0;
+	if (idlePerMs > 0) { idlePct = 100.0 * result.idle / (idlePerMs * (result.elapsed / 1000.0)); }
+	if (idlePct > 100.0) { idlePct = 100.0; }
+
+	Serial.print(chipName);
+	Serial.print(',');
+	Serial.print(mode);
+	Serial.print(',');
+	Serial.print(sps);
+	Serial.print(',');
+	Serial.print(result.samples);
+	Serial.print(',');
+	Serial.print(result.elapsed);
+	Serial.print(',');
+	Serial.print(result.samples / seconds, 1);
+	Serial.print(',');
+	Serial.print(result.latMin);
+	Serial.print(',');
+	Serial.print(result.calls ? result.latSum / result.calls : 0);
+	Serial.print(',');
+	Serial.print(percentile(50));
+	Serial.print(',');
+	Serial.print(percentile(90));
+	Serial.print(',');
+	Serial.print(percentile(99));
+	Serial.print(',');
+	Serial.print(result.latMax);
+	Serial.print(',');
+	Serial.print(idlePct, 1);
+	Serial.print(',');
+	Serial.println((unsigned long)result.timeouts);
+}
+
+/**
+ * @brief Blocking analogRead() with the given completion mode
+ *
+ * @param mode Completion mode to use
+ * @param name Name printed in the CSV
+ * @param sps Nominal data rate
+ */
+void runBlocking(ADS1x15_WAIT_t mode, const char *name, uint16_t sps)
+{
+	adc.setCompletionMode(mode);
+	beginRun();
+	while (!runDone())
+	{
+		uint32_t start = micros();
+		adc.analogRead(SE0);
+		addCall(micros() - start, 1);
+		if (adc.timedOut()) { break; }
+	}
+	endRun(name, sps);
+	adc.setCompletionMode(WAIT_DELAY);
+}
+
+/**
+ * @brief Continuous conversions collected into the ring buffer by update()
+ *
+ * @param sps Nominal data rate
+ */
+void runStreaming(uint16_t sps)
+{
+	adc.startContinuous(SE0, streamBuffer, sizeof(streamBuffer) / sizeof(streamBuffer[0]));
+	while (adc.available()) { adc.readBuffered(); }
+	beginRun();
+	uint32_t last = micros();
+	bool first = true;
+	while (!runDone())
+	{
+		adc.update();
+		if (adc.available())
+		{
+			while (adc.available()) { adc.readBuffered(); }
+			uint32_t now = micros();
+			if (!first) { addCall(now - last, 1); }
+			first = false;
+			last = now;
+		}
+		else { idle(); }
+		if ((micros() - last) > 1000000UL) { break; } // no samples arriving
+	}
+	endRun("stream", sps);
+	adc.stopContinuous();
+}
+
+/**
+ * @brief Pipelined scan of all four single ended inputs
+ *
+ * @param sps Nominal data rate
+ */
+void runScan(uint16_t sps)
+{
+	beginRun();
+	while (!runDone())
+	{
+		uint32_t start = micros();
+		adc.scan(scanList, scanCount, scanOut);
+		addCall(micros() - start, scanCount);
+		if (adc.timedOut()) { break; }
+	}
+	endRun("scan", sps);
+}
+
+/**
+ * @brief Scan of all four single ended inputs on both chips at once
+ *
+ * @param sps Nominal data rate
+ */
+void runBusScan(uint16_t sps)
+{
+	beginRun();
+	while (!runDone())
+	{
+		uint32_t start = micros();
+		bus.scan(scanList, scanCount, scanOut);
+		addCall(micros() - start, scanCount * bus.size());
+		if (bus.timedOut())
+		{
+			result.timeouts++;
+			break;
+		}
+	}
+	endRun("bus_scan", sps);
+}
+
+void setup()
+{
+	Serial.begin(115200);
+	while (!Serial) {}
+
+	adc.begin(adc.addressIndex(0), clockHz);
+	adc.setIdleHook(idle);
+	bus.add(adc);
+
+	// the second chip is optional, it is detected by a read that does not time out
+	adc2.begin(adc2.addressIndex(1), clockHz);
+	adc2.setIdleHook(idle);
+	adc2.analogRead(SE0);
+	haveSecond = !adc2.timedOut();
+	if (haveSecond) { bus.add(adc2); }
+
+	// the RDY mode is skipped if the pin never signals a conversion
+	if (adc.enableConversionReadyPin(rdyPin))
+	{
+		adc.setCompletionMode(WAIT_RDY_PIN);
+		adc.analogRead(SE0);
+		haveRdy = !adc.timedOut();
+		adc.clearTimeout();
+		adc.disableConversionReadyPin();
+		adc.setCompletionMode(WAIT_DELAY);
+	}
+
+	calibrateIdle();
+	Serial.println(F("chip,mode,rate_sps,samples,elapsed_us,samples_per_s,lat_min_us,lat_mean_us,lat_p50_us,lat_p90_us,lat_p99_us,lat_max_us,idle_pct,timeouts"));
+
+	for (uint8_t r = 0; r < rateCount; r++)
+	{
+		adc.setDataRate(rates[r]);
+		adc2.setDataRate(rates[r]);
+		uint16_t sps = rateSps[r];
+
+		runBlocking(WAIT_DELAY, "blocking", sps);
+		runBlocking(WAIT_OS_POLL, "os_poll", sps);
+		if (haveRdy)
+		{
+			adc.enableConversionReadyPin(rdyPin);
+			runBlocking(WAIT_RDY_PIN, "rdy_pin", sps);
+			adc.disableConversionReadyPin();
+		}
+		runStreaming(sps);
+		runScan(sps);
+		if (haveSecond) { runBusScan(sps); }
+	}
+	Serial.println(F("done"));
+}
+
+void loop()
+{
+}
@@ -1,5 +1,127 @@
 #include "ADS1x15.h"
 
+ADS1x15 *ADS1x15::alertOwner[ADS1x15_maxAlertPins] = {NULL, NULL, NULL, NULL};
+
+void ADS1x15_ISR_ATTR ADS1x15::alertISR0() {alertOwner[0]->handleAlert();}
+void ADS1x15_ISR_ATTR ADS1x15::alertISR1() {alertOwner[1]->handleAlert();}
+void ADS1x15_ISR_ATTR ADS1x15::alertISR2() {alertOwner[2]->handleAlert();}
+void ADS1x15_ISR_ATTR ADS1x15::alertISR3() {alertOwner[3]->handleAlert();}
+
+/**
+ * @brief Initialize the chip
+ *
+ * @param address Hardware address of the chip
+ */
+void ADS1x15::begin(uint8_t address)
+{
+	i2cAddress = address;
+	pointerRegister = ADS1x15_pointerUnknown;
+	deviceConfigValid = false; // the chip may have been reset since the last write
+	transport->begin();
+}
+
+/**
+ * @brief Initialize the chip and set the I2C clock
+ * @details Clocks up to 1 MHz (Fast-mode Plus) are set directly. Faster
+ * clocks enter HS-mode: the master code is sent at 400 kHz, then the clock is
+ * raised. A STOP condition returns the chip to F/S-mode, so in HS-mode every
+ * transfer ends with a repeated start instead; the I2C core must support
+ * this and the clock rate requested. Falls back to 400 kHz if HS-mode entry
+ * fails, or in lean builds, which have no HS-mode.
+ *
+ * @param address Hardware address of the chip
+ * @param clockHz I2C clock in Hz
+ */
+void ADS1x15::begin(uint8_t address, uint32_t clockHz)
+{
+	begin(address);
+#ifdef ADS1x15_LEAN
+	if (clockHz <= ADS1x15_fastModePlusClock) { transport->setClock(clockHz); }
+	else { transport->setClock(ADS1x15_fastModeClock); }
+#else
+	highSpeed = false;
+	if (clockHz <= ADS1x15_fastModePlusClock) { transport->setClock(clockHz); }
+	else if (transport->enterHighSpeed(clockHz)) { highSpeed = true; }
+	else { transport->setClock(ADS1x15_fastModeClock); }
+#endif
+}
+
+/**
+ * @brief Move the address pointer to a register unless it is already there
+ *
+ * @param reg Register to point to
+ * @return True on success (timeoutFlag is set on a bus error)
+ */
+bool ADS1x15::selectRegister(ADS1x15_Register_t reg)
+{
+	if (pointerRegister == (uint8_t)reg) { return true; }
+	ADS1x15_STAT(stats.transactions++; stats.bytes += 2);
+	if (!transport->setPointer(i2cAddress, (uint8_t)reg))
+	{
+		pointerRegister = ADS1x15_pointerUnknown;
+		flagTimeout();
+		return false;
+	}
+	pointerRegister = (uint8_t)reg;
+	return true;
+}
+
+/**
+ * @brief Read a register, only sending the pointer byte if it has moved
+ * @details The pointer write and the read are joined with a repeated start.
+ * Once the pointer is parked on CONVERSION_REG (e.g. while streaming) each
+ * read is a single 2 byte transfer.
+ *
+ * @param reg Register to read
+ * @return Register value, 0 on a bus error (timeoutFlag is set)
+ */
+uint16_t ADS1x15::readRegister(ADS1x15_Register_t reg)
+{
+	ADS1x15_LockGuard guard(transport->getLock());
+	uint16_t value = 0;
+	if (!selectRegister(reg)) { return 0; }
+	ADS1x15_STAT(stats.transactions++; stats.bytes += 3);
+	if (!transport->read(i2cAddress, value, !highSpeed))
+	{
+		flagTimeout();
+		return 0;
+	}
+	return value;
+}
+
+/**
+ * @brief Write a register, which also moves the address pointer to it
+ *
+ * @param reg Register to write
+ * @param value Value to write
+ * @return True on success (timeoutFlag is set on a bus error)
+ */
+bool ADS1x15::writeRegister(ADS1x15_Register_t reg, uint16_t value)
+{
+	ADS1x15_LockGuard guard(transport->getLock());
+	ADS1x15_STAT(stats.transactions++; stats.bytes += 4);
+	if (!transport->write(i2cAddress, (uint8_t)reg, value, !highSpeed))
+	{
+		pointerRegister = ADS1x15_pointerUnknown;
+		flagTimeout();
+		return false;
+	}
+	pointerRegister = (uint8_t)reg;
+	return true;
+}
+
+#ifdef ADS1x15_ENABLE_STATS
+/**
+ * @brief Clear the instrumentation counters
+ */
+void ADS1x15::resetStats()
+{
+	stats = ADS1x15_Stats();
+	latencyPending = false;
+	latencyStart = 0;
+}
+#endif
+
 /**
  * @brief Set the calibration factor for calculating the voltage or current input
  *
@@ -7,10 +129,8 @@
  */
 void ADS1x15::setCalibration(float calibration)
 {
-	this->calibration[0] = calibration;
-	this->calibration[1] = calibration;
-	this->calibration[2] = calibration;
-	this->calibration[3] = calibration;
+	for (uint8_t i = 0; i < 8; i++) { storeCalibration(i, calibration); }
+	updateScale();
 }
 
 /**
@@ -21,7 +141,122 @@ void ADS1x15::setCalibration(float calibration)
  */
 void ADS1x15::setCalibration(uint8_t ch, float calibration)
 {
-	this->calibration[ch % 4] = calibration;
+	storeCalibration(channelIndex(ch), calibration);
+	updateScale(channelIndex(ch));
+}
+
+/**
+ * @brief Set the calibration factor of a single ended or differential input
+ *
+ * @param mux The configuration of the MUX
+ * @param calibration Correction factor
+ */
+void ADS1x15::setCalibration(ADS1x15_MUX_t mux, float calibration)
+{
+	storeCalibration(muxIndex(mux), calibration);
+	updateScale(muxIndex(mux));
+}
+
+/**
+ * @brief Store the calibration factor of an input
+ *
+ * @param index Input to set, from muxIndex()
+ * @param calibration Correction factor
+ */
+void ADS1x15::storeCalibration(uint8_t index, float calibration)
+{
+#ifdef ADS1x15_LEAN
+	float q = calibration * ADS1x15_unityCalibration;
+	if (q >= 65535.0) { this->calibration[index] = 0xFFFF; }
+	else if (q > 0.0) { this->calibration[index] = (uint16_t)(q + 0.5); }
+	else { this->calibration[index] = 0; }
+#else
+	this->calibration[index] = calibration;
+#endif
+}
+
+/**
+ * @brief Recalculate the cached conversion scale of every input
+ */
+void ADS1x15::updateScale()
+{
+	for (uint8_t i = 0; i < 8; i++) { updateScale(i); }
+}
+
+/**
+ * @brief Recalculate the cached conversion scale of an input from the gain and calibration
+ *
+ * @param index Input to update, from muxIndex()
+ */
+void ADS1x15::updateScale(uint8_t index)
+{
+#ifdef ADS1x15_LEAN
+	(void)index; // calculated on demand by microvoltScaleOf()
+#else
+	computeScale(currentGain, calibration[index], voltScale[index], microvoltScale[index]);
+#endif
+}
+
+#ifdef ADS1x15_LEAN
+/**
+ * @brief Calculate the conversion scale of an input from the gain and calibration
+ * @details Integer math only, used instead of the scale tables in lean builds.
+ *
+ * @param index Input to calculate, from muxIndex()
+ * @return uV per LSB in Q16.16
+ */
+uint32_t ADS1x15::microvoltScaleOf(uint8_t index)
+{
+	uint16_t bits = getFullScaleBits();
+	if (bits == 0) { return 0; }
+	uint32_t uV = (uint32_t)ADS1x15_fullScaleMillivolts[(uint16_t)getGain() >> 9] * 1000UL;
+	uint32_t whole = uV / bits;
+	uint32_t fraction = ((uV % bits) << 16) / bits;
+	uint32_t cal = calibration[index];
+	uint32_t high = whole * cal; // whole < 2^12 for any gain and chip
+	if (high >= (1UL << 28)) { return 0xFFFFFFFFUL; }
+	return (high << 4) + ((fraction * cal) >> 12);
+}
+#endif
+
+/**
+ * @brief Calculate the conversion scale for a gain and calibration factor
+ *
+ * @param gain Gain value from ADS1x15_GAIN_t
+ * @param calibration Correction factor
+ * @param volts Output in V per LSB
+ * @param microvolts Output in uV per LSB, Q16.16
+ */
+void ADS1x15::computeScale(ADS1x15_GAIN_t gain, float calibration, float &volts, uint32_t &microvolts)
+{
+	uint16_t bits = getFullScaleBits();
+	if (bits == 0)
+	{
+		volts = 0.0;
+		microvolts = 0;
+		return;
+	}
+	float uV = ADS1x15_fullScaleMillivolts[(uint16_t)gain >> 9] * 1000.0 * calibration;
+	volts = uV * 0.000001 / (float)bits;
+	float q = uV * 65536.0 / (float)bits;
+	if (q >= 4294967295.0) { microvolts = 0xFFFFFFFFUL; }
+	else if (q > 0.0) { microvolts = (uint32_t)(q + 0.5); }
+	else { microvolts = 0; }
+}
+
+/**
+ * @brief Multiply a conversion result by a Q16.16 scale using only 16x16 bit products
+ *
+ * @param raw Converted value
+ * @param scale Scale factor in Q16.16
+ * @return Scaled value
+ */
+int32_t ADS1x15::applyScale(int16_t raw, uint32_t scale)
+{
+	uint16_t magnitude = (raw < 0) ? (uint16_t)(-(int32_t)raw) : (uint16_t)raw;
+	uint32_t value = (uint32_t)magnitude * (uint16_t)(scale >> 16);
+	value += ((uint32_t)magnitude * (uint16_t)(scale & 0xFFFF)) >> 16;
+	return (raw < 0) ? -(int32_t)value : (int32_t)value;
 }
 
 /**
@@ -45,9 +280,12 @@ float ADS1x15::resistorDivider(float r1, float r2)
  */
 void ADS1x15::setGain(ADS1x15_GAIN_t currentGain)
 {
+#ifndef ADS1x15_LEAN
 	this->currentGain = currentGain;
+#endif
 	configRegister &= ~(uint16_t)ADS1x15_GAIN_MASK;
 	configRegister |= (uint16_t)currentGain;
+	updateScale();
 }
 
 /**
@@ -57,14 +295,7 @@ void ADS1x15::setGain(ADS1x15_GAIN_t currentGain)
  */
 float ADS1x15::getFullScaleV(uint8_t ch)
 {
-	float value = 0.0;
-	if (currentGain == GAIN_23) {value = 6.144;}
-	else if (currentGain == GAIN_1) {value = 4.096;}
-	else if (currentGain == GAIN_2) {value = 2.048;}
-	else if (currentGain == GAIN_4) {value = 1.024;}
-	else if (currentGain == GAIN_8) {value = 0.512;}
-	else if (currentGain == GAIN_16) {value = 0.256;}
-	return value * calibration[ch % 4];
+	return ADS1x15_fullScaleMillivolts[(uint16_t)getGain() >> 9] * 0.001 * calibrationFactor(channelIndex(ch));
 }
 
 /**
@@ -101,22 +332,1142 @@ void ADS1x15::setComparatorLatch(ADS1x15_COMP_LAT_t compCfg)
 }
 
 /**
- * @brief Read an analog value
+ * @brief Set the conversion mode used by analogRead()
+ * @details In CONTINUOUS_CONV mode repeated reads with unchanged settings
+ * skip the config register write and return the latest conversion.
+ *
+ * @param mode Mode from ADS1x15_MODE_t
+ */
+void ADS1x15::setConversionMode(ADS1x15_MODE_t mode)
+{
+	configRegister &= ~(uint16_t)ADS1x15_MODE_MASK;
+	configRegister |= (uint16_t)mode;
+}
+
+/**
+ * @brief Write the config register unless the chip already holds the value
+ * @details A write is only skipped in continuous mode; in single shot mode
+ * the write itself starts the conversion.
+ *
+ * @param config Value for CONFIG_REG
+ * @return False if the write was skipped, true if it was attempted (a
+ * failed write flags a timeout and is not remembered)
+ */
+bool ADS1x15::writeConfig(uint16_t config)
+{
+	if (deviceConfigValid && (config & ADS1x15_MODE_MASK) == (uint16_t)CONTINUOUS_CONV &&
+	        ((config ^ deviceConfig) & ~ADS1x15_OS) == 0)
+	{
+		ADS1x15_STAT(stats.configWritesSkipped++);
+		return false;
+	}
+	if (!writeRegister(CONFIG_REG, config))
+	{
+		deviceConfigValid = false; // the chip state is unknown, write again next time
+		return true;
+	}
+	deviceConfig = config;
+	deviceConfigValid = true;
+	return true;
+}
+
+/**
+ * @brief Attach an interrupt to the ALERT/RDY pin
+ * @details The interrupt sets the flag read by alertTriggered() and calls
+ * the hook, if one is given. The pin edge follows the comparator polarity.
+ * Set the thresholds and queue before enabling the pin.
+ *
+ * @param pin Arduino pin connected to ALERT/RDY
+ * @param hook Function to call from the interrupt, or NULL (not in lean builds)
+ * @return True if the interrupt could be attached
+ */
+#ifdef ADS1x15_LEAN
+bool ADS1x15::enableAlertPin(uint8_t pin)
+#else
+bool ADS1x15::enableAlertPin(uint8_t pin, void (*hook)())
+#endif
+{
+	static void (*const isr[ADS1x15_maxAlertPins])() = {alertISR0, alertISR1, alertISR2, alertISR3};
+	int interrupt = digitalPinToInterrupt(pin);
+	if (interrupt == NOT_AN_INTERRUPT) { return false; }
+	disableAlertPin();
+	for (uint8_t i = 0; i < ADS1x15_maxAlertPins; i++)
+	{
+		if (alertOwner[i] == NULL)
+		{
+			alertSlot = i;
+			break;
+		}
+	}
+	if (alertSlot >= ADS1x15_maxAlertPins) { return false; }
+	alertOwner[alertSlot] = this;
+	alertPin = pin;
+#ifndef ADS1x15_LEAN
+	alertHook = hook;
+#endif
+	alertFlag = false;
+
+	pinMode(pin, INPUT_PULLUP); // ALERT/RDY is open drain
+	attachInterrupt(interrupt, isr[alertSlot],
+	                (configRegister & ADS1x15_COMP_POL_MASK) ? RISING : FALLING);
+	return true;
+}
+
+/**
+ * @brief Detach the ALERT/RDY pin interrupt and return to the delay completion mode
+ */
+void ADS1x15::disableAlertPin()
+{
+	if (alertSlot >= ADS1x15_maxAlertPins) { return; }
+	detachInterrupt(digitalPinToInterrupt(alertPin));
+	alertOwner[alertSlot] = NULL;
+	alertSlot = ADS1x15_maxAlertPins;
+#ifndef ADS1x15_LEAN
+	alertHook = NULL;
+#endif
+	if (waitMode == WAIT_RDY_PIN) { waitMode = WAIT_DELAY; }
+}
+
+/**
+ * @brief Check and clear the flag set by the ALERT/RDY pin interrupt
+ *
+ * @return True if the pin was asserted since the last call
+ */
+bool ADS1x15::alertTriggered()
+{
+	if (!alertFlag) { return false; }
+	alertFlag = false;
+	return true;
+}
+
+/**
+ * @brief Use the ALERT/RDY pin to signal the end of each conversion
+ * @details Attaches an interrupt to the pin, then programs the threshold
+ * registers for conversion ready mode (LOW_THRESH_REG MSB = 0,
+ * HI_THRESH_REG MSB = 1) and enables the comparator queue. The chip is only
+ * reprogrammed once the pin is usable, so a pin without an interrupt leaves
+ * the thresholds and completion mode untouched. The completion mode is set
+ * to WAIT_RDY_PIN.
+ *
+ * @param pin Arduino pin connected to ALERT/RDY
+ * @return True if the interrupt could be attached and the thresholds written
+ */
+bool ADS1x15::enableConversionReadyPin(uint8_t pin)
+{
+	if (!enableAlertPin(pin)) { return false; }
+	if (!writeRegister(LOW_THRESH_REG, 0x0000) || !writeRegister(HI_THRESH_REG, 0x8000))
+	{
+		disableAlertPin();
+		return false;
+	}
+	setComparatorQueue(QUE_ONE);
+	alertFlag = false; // ignore edges from the old comparator setup
+	waitMode = WAIT_RDY_PIN;
+	return true;
+}
+
+/**
+ * @brief Stop using the ALERT/RDY pin and return to the delay completion mode
+ */
+void ADS1x15::disableConversionReadyPin()
+{
+	disableAlertPin();
+	setComparatorQueue(QUE_DISABLE);
+}
+
+/**
+ * @brief Set the number of conversions past a threshold before ALERT/RDY asserts
+ *
+ * @param queue Setting from ADS1x15_QUE_t, QUE_DISABLE turns the pin off
+ */
+void ADS1x15::setComparatorQueue(ADS1x15_QUE_t queue)
+{
+	configRegister &= ~(uint16_t)ADS1x15_QUE_MASK;
+	configRegister |= (uint16_t)queue;
+}
+
+/**
+ * @brief Set the comparator thresholds as conversion results
+ *
+ * @param low Lower threshold
+ * @param high Upper threshold
+ */
+void ADS1x15::setThresholds(int16_t low, int16_t high)
+{
+	writeRegister(LOW_THRESH_REG, (uint16_t)((uint16_t)low << conversionShift));
+	writeRegister(HI_THRESH_REG, (uint16_t)((uint16_t)high << conversionShift));
+}
+
+/**
+ * @brief Set the comparator thresholds in V using the current gain and calibration
+ *
+ * @param ch Channel the thresholds apply to
+ * @param low Lower threshold in V
+ * @param high Upper threshold in V
+ */
+void ADS1x15::setThresholdVoltage(uint8_t ch, float low, float high)
+{
+	setThresholds(voltageToCode(ch, low), voltageToCode(ch, high));
+}
+
+/**
+ * @brief Convert a voltage to the nearest conversion result, clamped to full scale
+ *
+ * @param ch Channel the voltage applies to
+ * @param v Voltage in V
+ * @return Conversion result
+ */
+int16_t ADS1x15::voltageToCode(uint8_t ch, float v)
+{
+	float scale = voltScaleOf(channelIndex(ch));
+	int16_t limit = (int16_t)getFullScaleBits();
+	if (scale <= 0.0) { return 0; }
+	float code = v / scale;
+	if (code >= limit) { return limit; }
+	if (code <= -limit - 1) { return -limit - 1; }
+	return (int16_t)(code < 0.0 ? code - 0.5 : code + 0.5);
+}
+
+/**
+ * @brief Start a single shot conversion without waiting for the result
  *
  * @param mux The configuration of the MUX
- * @return The converted value
  */
-int16_t ADS1x15::analogRead(ADS1x15_MUX_t mux)
+void ADS1x15::startConversion(ADS1x15_MUX_t mux)
 {
-	uint16_t result;
 	configRegister &= ~(uint16_t)ADS1x15_MUX_MASK;
 	configRegister |= (uint16_t)mux;
 	configRegister |= ADS1x15_OS;
-	writeRegister(CONFIG_REG, configRegister);
-	delayMicroseconds(conversionDelay);
-	result = shiftConversion(readRegister(CONVERSION_REG));
-	if (result > getFullScaleBits()) { return (int16_t)(result | 0x8000); }
-	else { return (int16_t)result; }
+	beginConversion(configRegister, conversionDelay);
+}
+
+/**
+ * @brief Start one single shot conversion without waiting, whatever the conversion mode
+ * @details The config word is always written, so the conversion starts now
+ * even if the chip runs in continuous mode with the same settings. The
+ * conversion mode setting is not changed; the next read in continuous mode
+ * writes the config again.
+ *
+ * @param mux The configuration of the MUX
+ */
+void ADS1x15::startSingleShot(ADS1x15_MUX_t mux)
+{
+	configRegister &= ~(uint16_t)ADS1x15_MUX_MASK;
+	configRegister |= (uint16_t)mux;
+	uint16_t config = (configRegister & ~ADS1x15_MODE_MASK) | (uint16_t)SINGLE_SHOT | ADS1x15_OS;
+	beginConversion(config, conversionDelay);
+}
+
+/**
+ * @brief Start a single shot conversion from a precompiled profile without waiting
+ * @details The config word is written as is, so a wake-up costs one register
+ * write. The chip powers down again when the conversion is done; the MCU can
+ * sleep until the ALERT/RDY pin or conversionReady() and then call
+ * readConversion(). The profile is plain data and can be kept in memory that
+ * survives a deep sleep.
+ *
+ * @param profile Profile from makeProfile() or makeLowPowerProfile()
+ */
+void ADS1x15::startConversion(const ADS1x15_ChannelProfile &profile)
+{
+	beginConversion(profile.config, profile.delay);
+}
+
+/**
+ * @brief Write a complete config word to start a conversion
+ *
+ * @param config Value for CONFIG_REG
+ * @param delay Worst case conversion time in us
+ */
+void ADS1x15::beginConversion(uint16_t config, uint32_t delay)
+{
+#ifdef ADS1x15_LEAN
+	uint32_t offset = delay - conversionDelay; // wraps around for a shorter delay
+#else
+	pendingDelay = delay;
+	uint32_t offset = 0;
+#endif
+	sampleReady = false;
+	if (writeConfig(config))
+	{
+		uint32_t now = micros();
+		conversionStart = now + offset;
+		ADS1x15_STAT(latencyPending = true; latencyStart = now);
+	}
+	else
+	{
+		// continuous mode with unchanged settings, the latest result is valid
+		conversionStart = micros() - pendingTime();
+		sampleReady = true;
+	}
+}
+
+/**
+ * @brief Check if the conversion started by startConversion() has finished
+ * @details In WAIT_OS_POLL mode this reads the config register over I2C
+ * (single shot mode only, the OS bit has no meaning in continuous mode),
+ * in WAIT_RDY_PIN mode the flag set by the pin interrupt is checked,
+ * otherwise only the elapsed time is checked.
+ *
+ * @return True if the result can be read
+ */
+bool ADS1x15::conversionReady()
+{
+	if (waitMode == WAIT_OS_POLL && (deviceConfig & ADS1x15_MODE_MASK) == (uint16_t)SINGLE_SHOT)
+	{
+		return (readRegister(CONFIG_REG) & ADS1x15_OS) != 0;
+	}
+	if (waitMode == WAIT_RDY_PIN) { return sampleReady; }
+#ifdef ADS1x15_LEAN
+	// conversionStart is in the future for a conversion longer than conversionDelay
+	return (int32_t)(micros() - conversionStart) >= (int32_t)conversionDelay;
+#else
+	return (micros() - conversionStart) >= pendingDelay;
+#endif
+}
+
+/**
+ * @brief Read the result of the last conversion
+ *
+ * @return The converted value
+ */
+int16_t ADS1x15::readConversion()
+{
+	return shiftConversion(readResult());
+}
+
+/**
+ * @brief Read the conversion register and record the conversion latency
+ *
+ * @return Raw register value
+ */
+uint16_t ADS1x15::readResult()
+{
+	uint16_t value = readRegister(CONVERSION_REG);
+#ifdef ADS1x15_ENABLE_STATS
+	if (latencyPending)
+	{
+		uint32_t latency = micros() - latencyStart;
+		latencyPending = false;
+		if (stats.conversions == 0 || latency < stats.latencyMin) { stats.latencyMin = latency; }
+		if (latency > stats.latencyMax) { stats.latencyMax = latency; }
+		stats.latencySum += latency;
+		stats.conversions++;
+	}
+#endif
+	return value;
+}
+
+/**
+ * @brief Wait until the current conversion has finished
+ * @details Sets timeoutFlag if the chip does not report completion within timeoutTime ms.
+ *
+ * @return False on a timeout
+ */
+bool ADS1x15::waitForConversion()
+{
+	ADS1x15_STAT(uint32_t waitStart = micros());
+	uint32_t start = millis();
+	bool ready = true;
+	while (!conversionReady())
+	{
+		if ((millis() - start) > timeoutTime)
+		{
+			flagTimeout();
+			ready = false;
+			break;
+		}
+		idle();
+	}
+	ADS1x15_STAT(stats.waitMicros += micros() - waitStart);
+	return ready;
+}
+
+/**
+ * @brief Read an analog value
+ *
+ * @param mux The configuration of the MUX
+ * @return The converted value
+ */
+int16_t ADS1x15::analogRead(ADS1x15_MUX_t mux)
+{
+	ADS1x15_LockGuard guard(deviceLock);
+#ifndef ADS1x15_LEAN
+	if (autoRange)
+	{
+		ADS1x15_GAIN_t gain;
+		return autoRangeRead(mux, gain);
+	}
+#endif
+	startConversion(mux);
+	waitForConversion();
+	return readConversion();
+}
+
+/**
+ * @brief Precompile a channel profile into a ready to write config word
+ * @details The comparator bits are taken from the current configuration.
+ * The calibration factor of the input is applied.
+ *
+ * @param profile Profile to fill in
+ * @param mux The configuration of the MUX
+ * @param gain Gain value from ADS1x15_GAIN_t
+ * @param dataRate Data rate bits for the config register
+ * @param delay Worst case conversion time in us
+ */
+void ADS1x15::compileProfile(ADS1x15_ChannelProfile &profile, ADS1x15_MUX_t mux, ADS1x15_GAIN_t gain,
+                             uint16_t dataRate, uint32_t delay)
+{
+	const uint16_t compMask = ADS1x15_COMP_MODE_MASK | ADS1x15_COMP_POL_MASK | ADS1x15_COMP_LAT_MASK | ADS1x15_QUE_MASK;
+	profile.config = ADS1x15_OS | (uint16_t)mux | (uint16_t)gain | (uint16_t)SINGLE_SHOT |
+	                 (dataRate & ADS1x15_DR_MASK) | (configRegister & compMask);
+	profile.delay = trimDelay(delay);
+	float cal = calibrationFactor(muxIndex(mux));
+	computeScale(gain, cal, profile.scale, profile.microvoltScale);
+}
+
+/**
+ * @brief Read an analog value with a precompiled channel profile
+ * @details Writes the profile config word once and reads the result; the
+ * shared configuration used by analogRead() is not changed.
+ *
+ * @param profile Profile from makeProfile()
+ * @return The converted value
+ */
+int16_t ADS1x15::read(const ADS1x15_ChannelProfile &profile)
+{
+	ADS1x15_LockGuard guard(deviceLock);
+	beginConversion(profile.config, profile.delay);
+	waitForConversion();
+	return readConversion();
+}
+
+/**
+ * @brief Read an analog value in V with a precompiled channel profile
+ *
+ * @param profile Profile from makeProfile()
+ * @return The converted value in V
+ */
+float ADS1x15::readVoltage(const ADS1x15_ChannelProfile &profile)
+{
+	return profile.scale * (float)read(profile);
+}
+
+/**
+ * @brief Read an analog value in uV with a precompiled channel profile using integer math only
+ *
+ * @param profile Profile from makeProfile()
+ * @return The converted value in uV
+ */
+int32_t ADS1x15::readMicrovolts(const ADS1x15_ChannelProfile &profile)
+{
+	return applyScale(read(profile), profile.microvoltScale);
+}
+
+#ifndef ADS1x15_LEAN
+/**
+ * @brief Start a read that is completed by calling poll()
+ * @details For event loops: poll() never blocks, so other work can run
+ * during the conversion.
+ *
+ * @param mux The configuration of the MUX
+ */
+void ADS1x15::startRead(ADS1x15_MUX_t mux)
+{
+	startConversion(mux);
+	readStart = millis();
+	readState = READ_BUSY;
+}
+
+/**
+ * @brief Advance the read started by startRead()
+ *
+ * @return READ_DONE once the result can be taken with getResult()
+ */
+ADS1x15_READ_t ADS1x15::poll()
+{
+	if (readState != READ_BUSY) { return readState; }
+	if (conversionReady())
+	{
+		readResultValue = readConversion();
+		readState = READ_DONE;
+	}
+	else if ((millis() - readStart) > timeoutTime)
+	{
+		flagTimeout();
+		readState = READ_TIMEOUT;
+	}
+	return readState;
+}
+
+/**
+ * @brief Take the result of the read started by startRead()
+ *
+ * @return The converted value
+ */
+int16_t ADS1x15::getResult()
+{
+	readState = READ_IDLE;
+	return readResultValue;
+}
+#endif
+
+#ifdef ADS1x15_RTOS
+/**
+ * @brief Read an analog value, blocking only the calling task
+ * @details In WAIT_RDY_PIN mode the task sleeps until the ALERT/RDY
+ * interrupt notifies it. Otherwise it sleeps for the conversion time and
+ * then checks for completion once per tick.
+ *
+ * @param mux The configuration of the MUX
+ * @return The converted value
+ */
+int16_t ADS1x15::analogReadRTOS(ADS1x15_MUX_t mux)
+{
+	ADS1x15_LockGuard guard(deviceLock);
+	TickType_t timeout = pdMS_TO_TICKS(timeoutTime);
+	if (waitMode == WAIT_RDY_PIN)
+	{
+		ulTaskNotifyTake(pdTRUE, 0); // drop a stale notification
+		waitingTask = xTaskGetCurrentTaskHandle();
+		startConversion(mux);
+		if (!sampleReady && ulTaskNotifyTake(pdTRUE, timeout) == 0 && !sampleReady) { flagTimeout(); }
+		waitingTask = NULL;
+		return readConversion();
+	}
+	startConversion(mux);
+	TickType_t start = xTaskGetTickCount();
+	TickType_t sleep = pdMS_TO_TICKS(pendingTime() / 1000UL);
+	if (sleep > 0) { vTaskDelay(sleep); }
+	while (!conversionReady())
+	{
+		if ((xTaskGetTickCount() - start) > timeout)
+		{
+			flagTimeout();
+			break;
+		}
+		vTaskDelay(1);
+	}
+	return readConversion();
+}
+#endif
+
+#ifndef ADS1x15_LEAN
+/**
+ * @brief Enable or disable automatic gain selection
+ * @details Each MUX setting keeps its own gain, starting from the current
+ * gain. After a read the gain is raised if the result is below 3/8 of full
+ * scale and lowered above 15/16; a clipped result is read again at the lower
+ * gain. Only analogRead(), analogReadVoltage(), analogReadMicrovolts() and
+ * the current functions auto range; the voltage functions convert at the
+ * gain of that read. The configured gain from getGain() is not changed and
+ * every other read and conversion function keeps using it; see
+ * getGain(ADS1x15_MUX_t) for the gain of the last read of an input.
+ *
+ * @param enable True to enable auto ranging
+ */
+void ADS1x15::setAutoRange(bool enable)
+{
+	autoRange = enable;
+	for (uint8_t i = 0; i < 8; i++)
+	{
+		rangeGain[i] = (uint16_t)currentGain >> 9;
+		readGain[i] = rangeGain[i];
+	}
+}
+
+/**
+ * @brief Read an analog value with the auto ranging gain of the MUX setting
+ *
+ * @param mux The configuration of the MUX
+ * @param used Output, the gain of the returned value
+ * @return The converted value
+ */
+int16_t ADS1x15::autoRangeRead(ADS1x15_MUX_t mux, ADS1x15_GAIN_t &used)
+{
+	uint8_t index = muxIndex(mux);
+	uint16_t limit = getFullScaleBits();
+	for (;;)
+	{
+		uint8_t gain = rangeGain[index];
+		readGain[index] = gain;
+		used = (ADS1x15_GAIN_t)((uint16_t)gain << 9);
+		configRegister &= ~(uint16_t)ADS1x15_MUX_MASK;
+		configRegister |= (uint16_t)mux;
+		uint16_t config = (configRegister & ~ADS1x15_GAIN_MASK) | ((uint16_t)gain << 9) | ADS1x15_OS;
+		beginConversion(config, conversionDelay);
+		waitForConversion();
+		int16_t value = readConversion();
+		uint16_t magnitude = (value < 0) ? (uint16_t)(-(int32_t)value) : (uint16_t)value;
+		if (magnitude >= limit && gain > 0)
+		{
+			rangeGain[index] = gain - 1;
+			continue;
+		}
+		if (magnitude > limit - (limit >> 4) && gain > 0) { rangeGain[index] = gain - 1; }
+		else if (magnitude < (limit >> 2) + (limit >> 3) && gain < ((uint16_t)GAIN_16 >> 9)) { rangeGain[index] = gain + 1; }
+		return value;
+	}
+}
+#endif
+
+/**
+ * @brief Read a list of inputs, overlapping each result read with the next conversion
+ *
+ * @param list MUX configurations to convert, in order
+ * @param n Number of entries in list
+ * @param out Results, one per entry in list
+ */
+void ADS1x15::scan(const ADS1x15_MUX_t *list, uint8_t n, int16_t *out)
+{
+	ADS1x15_LockGuard guard(deviceLock);
+	ADS1x15_ScanCursor cursor;
+	scanBegin(cursor, list, n, out);
+	while (cursor.index < cursor.count)
+	{
+		waitForConversion();
+		scanStep(cursor);
+	}
+}
+
+/**
+ * @brief Start a non-blocking scan, completed by calling scanUpdate()
+ *
+ * @param cursor Scan progress, owned by the caller
+ * @param list MUX configurations to convert, in order
+ * @param n Number of entries in list
+ * @param out Results, one per entry in list
+ */
+void ADS1x15::scanBegin(ADS1x15_ScanCursor &cursor, const ADS1x15_MUX_t *list, uint8_t n, int16_t *out)
+{
+	cursor.list = list;
+	cursor.out = out;
+	cursor.count = n;
+	cursor.index = 0;
+	if (n > 0) { startConversion(list[0]); }
+}
+
+/**
+ * @brief Advance the scan started by scanBegin()
+ *
+ * @param cursor Scan progress passed to scanBegin()
+ * @return True once all results are in the output array
+ */
+bool ADS1x15::scanUpdate(ADS1x15_ScanCursor &cursor)
+{
+	if (cursor.index >= cursor.count) { return true; }
+	if (!conversionReady()) { return false; }
+	scanStep(cursor);
+	return cursor.index >= cursor.count;
+}
+
+/**
+ * @brief Collect the finished scan conversion and start the next one
+ * @details The conversion register keeps the previous result until the new
+ * conversion ends, so at slow enough rates the next conversion is started first.
+ *
+ * @param cursor Scan progress
+ */
+void ADS1x15::scanStep(ADS1x15_ScanCursor &cursor)
+{
+	uint8_t i = cursor.index++;
+	bool more = cursor.index < cursor.count;
+	if (more && conversionDelay >= ADS1x15_pipelineMinDelay)
+	{
+		// the result read belongs to the previous conversion, keep its latency
+		ADS1x15_STAT(uint32_t previousStart = latencyStart; bool previousPending = latencyPending);
+		startConversion(cursor.list[i + 1]);
+		ADS1x15_STAT(uint32_t nextStart = latencyStart; bool nextPending = latencyPending);
+		ADS1x15_STAT(latencyStart = previousStart; latencyPending = previousPending);
+		cursor.out[i] = readConversion();
+		ADS1x15_STAT(latencyStart = nextStart; latencyPending = nextPending);
+	}
+	else
+	{
+		cursor.out[i] = readConversion();
+		if (more) { startConversion(cursor.list[i + 1]); }
+	}
+}
+
+/**
+ * @brief Read an input several times back to back in continuous mode and filter the results
+ * @details The config register is written once for all samples. After the
+ * first sample the timed wait is the continuous sample period (see update()),
+ * not the single shot conversion time. The chip is returned to its previous
+ * conversion mode afterwards.
+ *
+ * FILTER_BOXCAR returns the average in the units of analogRead().
+ * FILTER_DECIMATE returns the sum shifted right by log2Samples - log2Samples / 2,
+ * which adds log2Samples / 2 bits of resolution (e.g. 16 samples give a 14 bit
+ * ADS1015 result).
+ * FILTER_EMA feeds every sample into a moving average with a time constant of
+ * 2^log2Samples samples that is kept between calls, and returns it in the units of analogRead().
+ * Lean builds keep no state between calls and return the FILTER_BOXCAR average instead.
+ *
+ * @param mux The configuration of the MUX
+ * @param log2Samples Number of samples as a power of two, 0 to 16
+ * @param filter Filter from ADS1x15_FILTER_t
+ * @return The filtered value, 0 if a conversion timed out (see timedOut())
+ */
+int32_t ADS1x15::oversample(ADS1x15_MUX_t mux, uint8_t log2Samples, ADS1x15_FILTER_t filter)
+{
+	ADS1x15_LockGuard guard(deviceLock);
+	if (log2Samples > 16) { log2Samples = 16; }
+	uint32_t samples = 1UL << log2Samples;
+	uint16_t previousConfig = configRegister;
+	int32_t sum = 0;
+	bool complete = true;
+
+	configRegister &= ~(uint16_t)(ADS1x15_MUX_MASK | ADS1x15_MODE_MASK | ADS1x15_OS);
+	configRegister |= (uint16_t)mux | (uint16_t)CONTINUOUS_CONV;
+	beginConversion(configRegister, conversionDelay);
+	for (uint32_t i = 0; i < samples; i++)
+	{
+		if (!waitForConversion())
+		{
+			complete = false;
+			break;
+		}
+		sampleReady = false;
+		uint32_t now = micros();
+		if (i == 0)
+		{
+			conversionStart = now;
+#ifndef ADS1x15_LEAN
+			pendingDelay = streamPeriod(); // the next samples follow every sample period
+#endif
+		}
+		else if (pendingTime() > 0)
+		{
+			// stay on the chip's sample grid, as update() does
+			conversionStart += ((now - conversionStart) / pendingTime()) * pendingTime();
+		}
+		int16_t value = readConversion();
+		sum += value;
+#ifndef ADS1x15_LEAN
+		if (filter == FILTER_EMA)
+		{
+			if (!filterValid)
+			{
+				filterState = (int32_t)value << 8;
+				filterValid = true;
+			}
+			filterState += (((int32_t)value << 8) - filterState) >> log2Samples;
+		}
+#endif
+	}
+
+	configRegister = previousConfig & ~ADS1x15_OS;
+	if ((previousConfig & ADS1x15_MODE_MASK) == (uint16_t)SINGLE_SHOT) { writeConfig(configRegister); }
+	if (!complete) { return 0; }
+#ifndef ADS1x15_LEAN
+	if (filter == FILTER_EMA) { return filterState >> 8; }
+#endif
+	if (filter == FILTER_DECIMATE) { return sum >> (log2Samples - log2Samples / 2); }
+	return sum >> log2Samples;
+}
+
+/**
+ * @brief Put the chip in continuous conversion mode and stream samples into a buffer
+ * @details Samples are collected by update() or harvest() and drained with
+ * available() and readBuffered(). The buffer holds size - 1 samples. Do not
+ * call analogRead() while streaming. With a NULL buffer the chip converts
+ * without streaming, for example to run the threshold comparator.
+ *
+ * @param mux The configuration of the MUX
+ * @param buffer Storage for the samples, owned by the caller
+ * @param size Number of elements in buffer
+ */
+void ADS1x15::startContinuous(ADS1x15_MUX_t mux, int16_t *buffer, uint8_t size)
+{
+	resetStream(size);
+	streamData = buffer;
+	configRegister &= ~(uint16_t)(ADS1x15_MUX_MASK | ADS1x15_MODE_MASK | ADS1x15_OS);
+	configRegister |= (uint16_t)mux | (uint16_t)CONTINUOUS_CONV;
+	beginConversion(configRegister, conversionDelay);
+}
+
+/**
+ * @brief Put the chip in continuous conversion mode and stream timestamped samples into a buffer
+ * @details As startContinuous(ADS1x15_MUX_t, int16_t *, uint8_t); drain the
+ * buffer with readSample(). In WAIT_RDY_PIN mode the timestamp is the time of
+ * the ALERT/RDY edge, so the sample clock is the chip's own oscillator.
+ *
+ * @param mux The configuration of the MUX
+ * @param buffer Storage for the samples, owned by the caller
+ * @param size Number of elements in buffer
+ */
+void ADS1x15::startContinuous(ADS1x15_MUX_t mux, ADS1x15_Sample *buffer, uint8_t size)
+{
+	startContinuous(mux, (int16_t *)NULL, 0);
+	resetStream(size);
+	streamData = buffer;
+	streamTimestamped = true;
+}
+
+/**
+ * @brief Leave continuous conversion mode and power down the chip
+ */
+void ADS1x15::stopContinuous()
+{
+	while (streamPending && transport->busy()) {}
+	releaseStreamLock();
+	configRegister &= ~(uint16_t)(ADS1x15_MODE_MASK | ADS1x15_OS);
+	configRegister |= (uint16_t)SINGLE_SHOT;
+	writeConfig(configRegister);
+	resetStream(0);
+}
+
+#ifndef ADS1x15_LEAN
+/**
+ * @brief Sample a list of inputs in single shot mode on a fixed time grid
+ * @details Each tick starts a conversion of the next input in the list; the
+ * record gets the time the conversion actually started as its timestamp, so
+ * a late update() shows up in the timestamps. The largest delay between a
+ * tick and its conversion is reported by getScheduleLateness(). Ticks come
+ * from update() every periodUs, or from a hardware timer calling timerTick()
+ * if periodUs is 0.
+ * Ticks that arrive while a conversion is still running are counted as
+ * overruns. Drain the buffer with readSample().
+ *
+ * @param list MUX configurations to convert in turn
+ * @param n Number of entries in list
+ * @param periodUs Time between conversions in us, 0 for timerTick()
+ * @param buffer Storage for the samples, owned by the caller
+ * @param size Number of elements in buffer
+ */
+void ADS1x15::startScheduled(const ADS1x15_MUX_t *list, uint8_t n, uint32_t periodUs,
+                             ADS1x15_Sample *buffer, uint8_t size)
+{
+	resetStream(size);
+	streamData = buffer;
+	streamTimestamped = true;
+	scheduleList = list;
+	scheduleCount = n;
+	scheduleIndex = 0;
+	schedulePeriod = periodUs;
+	scheduleBusy = false;
+	scheduleLateness = 0;
+	tickPending = false;
+	configRegister &= ~(uint16_t)ADS1x15_MODE_MASK;
+	configRegister |= (uint16_t)SINGLE_SHOT;
+	nextTick = micros();
+}
+
+/**
+ * @brief Stop scheduled sampling, the chip powers down after the last conversion
+ */
+void ADS1x15::stopScheduled()
+{
+	scheduleList = NULL;
+	scheduleCount = 0;
+	resetStream(0);
+}
+
+/**
+ * @brief Mark a scheduled sampling tick, safe to call from a timer interrupt
+ */
+void ADS1x15::timerTick()
+{
+	tickTime = micros();
+	tickPending = true;
+}
+#endif
+
+/**
+ * @brief Clear the stream buffer state
+ *
+ * @param size Number of elements in the new buffer
+ */
+void ADS1x15::resetStream(uint8_t size)
+{
+	streamData = NULL;
+	streamTimestamped = false;
+	streamSize = size;
+	streamHead = 0;
+	streamTail = 0;
+	streamOverruns = 0;
+	streamPending = false;
+	streamPrimed = false;
+	releaseStreamLock();
+}
+
+/**
+ * @brief Collect a sample into the stream buffer if a new conversion is available
+ * @details Uses the ALERT/RDY pin in WAIT_RDY_PIN mode. Otherwise a sample is
+ * due every streamPeriod(); each whole period that passed without a call is
+ * counted as an overrun. Until calibrateTiming() has measured the chip, the
+ * period is that of the slowest chip in spec (10% longer than nominal), so a
+ * conversion is never read twice but a faster chip delivers up to 10% fewer
+ * samples than its data rate. Calibrate, or use WAIT_RDY_PIN, for the full rate. Also completes a background read started by
+ * harvest(), and runs the scheduler started by startScheduled() (not in lean builds).
+ *
+ * @return True if a sample was collected
+ */
+bool ADS1x15::update()
+{
+#ifndef ADS1x15_LEAN
+	if (scheduleList != NULL) { return scheduleUpdate(); }
+#endif
+	if (streamData == NULL) { return false; }
+	if (streamPending)
+	{
+		if (transport->busy()) { return false; }
+		streamCommit();
+	}
+	if (waitMode == WAIT_RDY_PIN)
+	{
+		if (!sampleReady) { return false; }
+	}
+	else
+	{
+		uint32_t start = conversionStart;
+		uint32_t elapsed = micros() - start;
+		uint32_t period = streamPrimed ? streamPeriod() : conversionDelay;
+		if (elapsed < period) { return false; }
+		if (streamPrimed && period > 0)
+		{
+			uint32_t periods = elapsed / period;
+			if (periods > 1)
+			{
+				streamOverruns += periods - 1;
+				ADS1x15_STAT(stats.overruns += periods - 1);
+			}
+			harvest();
+			conversionStart = start + periods * period; // stay on the chip's sample grid
+			return true;
+		}
+		streamPrimed = true;
+	}
+	harvest();
+	return true;
+}
+
+#ifndef ADS1x15_LEAN
+/**
+ * @brief Run one step of the scheduled sampling
+ *
+ * @return True if a sample was collected
+ */
+bool ADS1x15::scheduleUpdate()
+{
+	bool collected = false;
+	if (scheduleBusy && conversionReady())
+	{
+		scheduleBusy = false;
+		uint16_t raw = readResult();
+		ADS1x15_Sample *slot = streamSlot();
+		if (slot != NULL)
+		{
+			slot->timestamp = scheduleTime;
+			slot->mux = (uint16_t)scheduleMux;
+			slot->raw = (int16_t)raw;
+			streamCommit();
+			collected = true;
+		}
+	}
+
+	uint32_t now = micros();
+	bool due;
+	uint32_t tick;
+	if (schedulePeriod == 0)
+	{
+		due = tickPending;
+		tick = tickTime;
+	}
+	else
+	{
+		due = (int32_t)(now - nextTick) >= 0;
+		tick = nextTick;
+	}
+	if (!due) { return collected; }
+	tickPending = false;
+	if (schedulePeriod != 0)
+	{
+		// keep the grid, skipping ticks that were missed completely
+		do { nextTick += schedulePeriod; } while ((int32_t)(now - nextTick) >= 0);
+	}
+	if (scheduleBusy)
+	{
+		streamOverruns++;
+		ADS1x15_STAT(stats.overruns++);
+		return collected;
+	}
+	scheduleMux = scheduleList[scheduleIndex];
+	if (++scheduleIndex >= scheduleCount) { scheduleIndex = 0; }
+	scheduleBusy = true;
+	startConversion(scheduleMux);
+	scheduleTime = conversionStart;
+	if (conversionStart - tick > scheduleLateness) { scheduleLateness = conversionStart - tick; }
+	return collected;
+}
+#endif
+
+/**
+ * @brief Read the conversion register into the stream buffer unconditionally
+ * @details Call from the main loop or a task, at the data rate, instead of
+ * update(). It runs a bus transfer and takes the bus lock, so it must not be
+ * called from an interrupt. The read goes straight into the buffer with
+ * ADS1x15_Transport::readAsync(); if the transport finishes it in the
+ * background, update() adds it to the buffer. The bus lock is held until then.
+ */
+void ADS1x15::harvest()
+{
+	if (streamData == NULL || streamPending) { return; }
+#ifdef ADS1x15_LEAN
+	uint32_t timestamp = micros();
+#else
+	uint32_t timestamp = (waitMode == WAIT_RDY_PIN && sampleReady) ? alertTime : micros();
+#endif
+	sampleReady = false;
+	conversionStart = micros();
+	uint16_t *dest;
+	if (streamTimestamped)
+	{
+		ADS1x15_Sample *slot = streamSlot();
+		if (slot == NULL) { return; }
+		slot->timestamp = timestamp;
+		slot->mux = configRegister & ADS1x15_MUX_MASK;
+		dest = (uint16_t *)&slot->raw;
+	}
+	else
+	{
+		if (streamFull()) { return; }
+		dest = (uint16_t *)&streamBuffer()[streamHead];
+	}
+	// the bus stays locked until the read has completed, see streamCommit()
+#ifdef ADS1x15_LEAN
+	if (transport->getLock() != NULL)
+	{
+		transport->getLock()->lock();
+		streamLocked = true;
+	}
+#else
+	streamLock = transport->getLock();
+	if (streamLock != NULL) { streamLock->lock(); }
+#endif
+	if (!selectRegister(CONVERSION_REG))
+	{
+		releaseStreamLock();
+		return;
+	}
+	ADS1x15_STAT(stats.transactions++; stats.bytes += 3);
+	if (!transport->readAsync(i2cAddress, dest, !highSpeed))
+	{
+		releaseStreamLock();
+		flagTimeout();
+		return;
+	}
+	streamPending = true;
+	if (!transport->busy()) { streamCommit(); }
+}
+
+/**
+ * @brief Check if the stream buffer is full, counting an overrun if it is
+ *
+ * @return True if there is no room for another sample
+ */
+bool ADS1x15::streamFull()
+{
+	uint8_t next = streamHead + 1;
+	if (next >= streamSize) { next = 0; }
+	if (next != streamTail) { return false; }
+	streamOverruns++;
+	ADS1x15_STAT(stats.overruns++);
+	return true;
+}
+
+/**
+ * @brief Get the next free record in the stream buffer
+ *
+ * @return Record to fill in, NULL if the buffer is full
+ */
+ADS1x15_Sample *ADS1x15::streamSlot()
+{
+	if (!streamTimestamped || streamFull()) { return NULL; }
+	return &streamRecords()[streamHead];
+}
+
+/**
+ * @brief Add the sample at the head of the stream buffer
+ */
+void ADS1x15::streamCommit()
+{
+	uint8_t next = streamHead + 1;
+	if (next >= streamSize) { next = 0; }
+	streamPending = false;
+	streamHead = next;
+	releaseStreamLock();
+}
+
+/**
+ * @brief Release the bus lock taken by harvest() for a background read
+ */
+void ADS1x15::releaseStreamLock()
+{
+#ifdef ADS1x15_LEAN
+	if (!streamLocked) { return; }
+	streamLocked = false;
+	transport->getLock()->unlock();
+#else
+	if (streamLock == NULL) { return; }
+	ADS1x15_Lock *lock = streamLock;
+	streamLock = NULL;
+	lock->unlock();
+#endif
+}
+
+/**
+ * @brief Get the number of samples waiting in the stream buffer
+ *
+ * @return Number of samples
+ */
+uint8_t ADS1x15::available()
+{
+	uint8_t head = streamHead;
+	if (head >= streamTail) { return head - streamTail; }
+	else { return streamSize - streamTail + head; }
+}
+
+/**
+ * @brief Remove the oldest sample from the stream buffer
+ *
+ * @return The converted value, 0 if the buffer is empty
+ */
+int16_t ADS1x15::readBuffered()
+{
+	ADS1x15_Sample sample;
+	if (!readSample(sample)) { return 0; }
+	return sample.raw;
+}
+
+/**
+ * @brief Remove the oldest sample from the stream buffer with its timestamp
+ * @details Samples streamed into an int16_t buffer have a timestamp of 0 and
+ * the MUX setting of the stream.
+ *
+ * @param sample Output; raw holds the converted value
+ * @return True if a sample was available
+ */
+bool ADS1x15::readSample(ADS1x15_Sample &sample)
+{
+	uint8_t tail = streamTail;
+	if (tail == streamHead) { return false; }
+	if (streamTimestamped)
+	{
+		sample = streamRecords()[tail];
+		sample.raw = shiftConversion((uint16_t)sample.raw);
+	}
+	else
+	{
+		sample.timestamp = 0;
+		sample.mux = configRegister & ADS1x15_MUX_MASK;
+		sample.raw = shiftConversion((uint16_t)streamBuffer()[tail]);
+	}
+	tail++;
+	if (tail >= streamSize) { tail = 0; }
+	streamTail = tail;
+	return true;
 }
 
 /**
@@ -125,7 +1476,7 @@ int16_t ADS1x15::analogRead(ADS1x15_MUX_t mux)
  * @param ch The input channel to read
  * @return The converted value
  */
-uint16_t ADS1x15::analogRead(uint8_t ch)
+int16_t ADS1x15::analogRead(uint8_t ch)
 {
 	if (ch == 0) { return analogRead(SE0); }
 	else if (ch == 1) { return analogRead(SE1); }
@@ -142,7 +1493,115 @@ uint16_t ADS1x15::analogRead(uint8_t ch)
  */
 float ADS1x15::analogReadVoltage(uint8_t ch)
 {
-	return getFullScaleV(ch) * ((float)analogRead(ch) / (float)getFullScaleBits());
+	if (ch > 3) { return 0.0; }
+#ifndef ADS1x15_LEAN
+	if (autoRange)
+	{
+		ADS1x15_LockGuard guard(deviceLock);
+		ADS1x15_GAIN_t gain;
+		int16_t raw = autoRangeRead((ADS1x15_MUX_t)(SE0 + ((uint16_t)ch << 12)), gain);
+		float volts;
+		uint32_t microvolts;
+		computeScale(gain, calibration[channelIndex(ch)], volts, microvolts);
+		return volts * (float)raw;
+	}
+#endif
+	return voltScaleOf(channelIndex(ch)) * (float)analogRead(ch);
+}
+
+/**
+ * @brief Read an input and calculate the voltage using integer math only
+ *
+ * @param ch The input channel to read
+ * @return The converted value in uV
+ */
+int32_t ADS1x15::analogReadMicrovolts(uint8_t ch)
+{
+	if (ch > 3) { return 0; }
+	ADS1x15_MUX_t mux = (ADS1x15_MUX_t)(SE0 + ((uint16_t)ch << 12));
+#ifndef ADS1x15_LEAN
+	if (autoRange)
+	{
+		ADS1x15_LockGuard guard(deviceLock);
+		ADS1x15_GAIN_t gain;
+		int16_t raw = autoRangeRead(mux, gain);
+		float volts;
+		uint32_t microvolts;
+		computeScale(gain, calibration[channelIndex(ch)], volts, microvolts);
+		return applyScale(raw, microvolts);
+	}
+#endif
+	return applyScale(analogRead(mux), microvoltScaleOf(channelIndex(ch)));
+}
+
+/**
+ * @brief Read an input and calculate the current using integer math only
+ *
+ * @param ch The input channel to read
+ * @param r Burden resistor value in ohms
+ *
+ * @return The converted value in uA
+ */
+int32_t ADS1x15::analogReadMicroamps(uint8_t ch, uint16_t r)
+{
+	if (r > 0) { return analogReadMicrovolts(ch) / (int32_t)r; }
+	else { return 0; }
+}
+
+/**
+ * @brief Convert an array of results to V using the current gain and calibration
+ *
+ * @param raw Converted values
+ * @param out Output in V, may not overlap raw
+ * @param n Number of values
+ * @param ch Channel the values were read from
+ */
+void ADS1x15::convertToVolts(const int16_t *raw, float *out, size_t n, uint8_t ch)
+{
+	const float scale = voltScaleOf(channelIndex(ch));
+	for (size_t i = 0; i < n; i++) { out[i] = scale * (float)raw[i]; }
+}
+
+/**
+ * @brief Convert an array of results to uV using integer math only
+ *
+ * @param raw Converted values
+ * @param out Output in uV, may not overlap raw
+ * @param n Number of values
+ * @param ch Channel the values were read from
+ */
+void ADS1x15::convertToMicrovolts(const int16_t *raw, int32_t *out, size_t n, uint8_t ch)
+{
+	const uint32_t scale = microvoltScaleOf(channelIndex(ch));
+	for (size_t i = 0; i < n; i++) { out[i] = applyScale(raw[i], scale); }
+}
+
+/**
+ * @brief Convert the results of a scan set to V, each with the scale of its input
+ *
+ * @param set Set filled in by scan()
+ * @param out Output in V, one per entry
+ */
+void ADS1x15::convertToVolts(const ADS1x15_ScanSet &set, float *out)
+{
+	for (uint8_t i = 0; i < set.size(); i++)
+	{
+		out[i] = voltScaleOf(muxIndex(set.mux(i))) * (float)set.value(i);
+	}
+}
+
+/**
+ * @brief Convert the results of a scan set to uV using integer math only
+ *
+ * @param set Set filled in by scan()
+ * @param out Output in uV, one per entry
+ */
+void ADS1x15::convertToMicrovolts(const ADS1x15_ScanSet &set, int32_t *out)
+{
+	for (uint8_t i = 0; i < set.size(); i++)
+	{
+		out[i] = applyScale(set.value(i), microvoltScaleOf(muxIndex(set.mux(i))));
+	}
 }
 
 /**
@@ -174,38 +1633,159 @@ float ADS1x15::analogRead420(uint8_t ch, float r)
 }
 
 /**
- * @brief Set the conversion rate in samples per second
+ * @brief Set the data rate bits and the matching conversion time
  *
- * @param dataRate One of the rate settings from ADS1115_DR_t
+ * @param dataRate Data rate bits for the config register
+ * @param delay Worst case conversion time in us
+ * @param period Nominal time between continuous conversions in us
  */
-void ADS1115::setDataRate(ADS1115_DR_t dataRate)
+void ADS1x15::applyDataRate(uint16_t dataRate, uint32_t delay, uint32_t period)
 {
+#ifdef ADS1x15_LEAN
+	(void)period; // lean builds stream at the worst case conversion time
+#else
+	samplePeriod = period;
+#endif
 	configRegister &= ~(uint16_t)ADS1x15_DR_MASK;
-	configRegister |= (uint16_t)dataRate;
-	if (dataRate == ADS1115_DR_8) { conversionDelay = 125400; }
-	if (dataRate == ADS1115_DR_16) { conversionDelay = 62900; }
-	if (dataRate == ADS1115_DR_32) { conversionDelay = 31650; }
-	if (dataRate == ADS1115_DR_64) { conversionDelay = 16025; }
-	if (dataRate == ADS1115_DR_128) { conversionDelay = 8213; }
-	if (dataRate == ADS1115_DR_250) { conversionDelay = 4400; }
-	if (dataRate == ADS1115_DR_475) { conversionDelay = 2505; }
-	if (dataRate == ADS1115_DR_860) { conversionDelay = 1563; }
+	configRegister |= dataRate & ADS1x15_DR_MASK;
+	conversionDelay = trimDelay(delay);
+}
+
+#ifndef ADS1x15_LEAN
+/**
+ * @brief Scale a worst case conversion time by the measured oscillator speed
+ *
+ * @param delay Worst case conversion time in us
+ * @return Conversion time in us for this chip
+ */
+uint32_t ADS1x15::trimDelay(uint32_t delay)
+{
+	return (delay * timingTrim) >> 12;
+}
+
+/**
+ * @brief Measure the conversion time of this chip and tighten the timed waits
+ * @details Runs single shot conversions at the current settings, polling the
+ * OS bit, and keeps the longest time to completion plus 1/64 as margin. The
+ * ratio to the current conversion time is applied to every data rate, since
+ * all rates come from the same internal oscillator, so it is kept by later
+ * setDataRate() calls. The shortest time sets the sample period used by
+ * continuous streaming in the same way. Leaves the chip powered down.
+ *
+ * @param conversions Number of conversions to time
+ * @return Measured conversion time in us, 0 on a timeout (timings are unchanged)
+ */
+uint32_t ADS1x15::calibrateTiming(uint8_t conversions)
+{
+	ADS1x15_LockGuard guard(deviceLock);
+	uint16_t config = (configRegister & ~ADS1x15_MODE_MASK) | (uint16_t)SINGLE_SHOT | ADS1x15_OS;
+	uint32_t longest = 0;
+	uint32_t shortest = 0xFFFFFFFFUL;
+	for (uint8_t i = 0; i < conversions; i++)
+	{
+		writeConfig(config);
+		uint32_t start = micros();
+		uint32_t elapsed;
+		for (;;)
+		{
+			bool done = (readRegister(CONFIG_REG) & ADS1x15_OS) != 0;
+			elapsed = micros() - start;
+			if (done) { break; }
+			if (elapsed > timeoutTime * 1000UL)
+			{
+				flagTimeout();
+				return 0;
+			}
+		}
+		if (elapsed > longest) { longest = elapsed; }
+		if (elapsed < shortest) { shortest = elapsed; }
+	}
+	if (longest == 0 || conversionDelay == 0) { return longest; }
+
+	uint32_t tightened = longest + (longest >> 6);
+	uint32_t trim = (uint32_t)(((uint64_t)tightened * timingTrim) / conversionDelay);
+	if (trim < 1) { trim = 1; }
+	if (trim > ADS1x15_maxTimingTrim) { trim = ADS1x15_maxTimingTrim; }
+	timingTrim = (uint16_t)trim;
+	conversionDelay = tightened;
+	if (samplePeriod > 0)
+	{
+		// rounded up, a period that is too short reads a conversion twice
+		trim = (uint32_t)((((uint64_t)shortest << 12) + samplePeriod - 1) / samplePeriod);
+		if (trim < 1) { trim = 1; }
+		if (trim > ADS1x15_maxTimingTrim) { trim = ADS1x15_maxTimingTrim; }
+		periodTrim = (uint16_t)trim;
+	}
+	return longest;
+}
+#endif
+
+/**
+ * @brief Get the worst case conversion time for a data rate
+ *
+ * @param dataRate One of the rate settings from ADS1115_DR_t
+ * @return Conversion time in us
+ */
+uint32_t ADS1115_Traits::conversionDelay(ADS1115_DR_t dataRate)
+{
+	if (dataRate == ADS1115_DR_8) { return 125400; }
+	if (dataRate == ADS1115_DR_16) { return 62900; }
+	if (dataRate == ADS1115_DR_32) { return 31650; }
+	if (dataRate == ADS1115_DR_64) { return 16025; }
+	if (dataRate == ADS1115_DR_128) { return 8213; }
+	if (dataRate == ADS1115_DR_250) { return 4400; }
+	if (dataRate == ADS1115_DR_475) { return 2505; }
+	return 1563; // ADS1115_DR_860
 }
 
 /**
- * @brief Set the conversion rate in samples per second
+ * @brief Get the worst case conversion time for a data rate
  *
  * @param dataRate One of the rate settings from ADS1015_DR_t
+ * @return Conversion time in us
  */
-void ADS1015::setDataRate(ADS1015_DR_t dataRate)
-{
-	configRegister &= ~ADS1x15_DR_MASK;
-	configRegister |= (uint16_t)dataRate;
-	if (dataRate == ADS1015_DR_128) { conversionDelay = 8213; }
-	if (dataRate == ADS1015_DR_250) { conversionDelay = 4400; }
-	if (dataRate == ADS1015_DR_490) { conversionDelay = 2441; }
-	if (dataRate == ADS1015_DR_920) { conversionDelay = 1487; }
-	if (dataRate == ADS1015_DR_1600) { conversionDelay = 1025; }
-	if (dataRate == ADS1015_DR_2400) { conversionDelay = 817; }
-	if (dataRate == ADS1015_DR_3300) { conversionDelay = 703; }
+uint32_t ADS1015_Traits::conversionDelay(ADS1015_DR_t dataRate)
+{
+	if (dataRate == ADS1015_DR_128) { return 8213; }
+	if (dataRate == ADS1015_DR_250) { return 4400; }
+	if (dataRate == ADS1015_DR_490) { return 2441; }
+	if (dataRate == ADS1015_DR_920) { return 1487; }
+	if (dataRate == ADS1015_DR_1600) { return 1025; }
+	if (dataRate == ADS1015_DR_2400) { return 817; }
+	return 703; // ADS1015_DR_3300
+}
+
+/**
+ * @brief Get the nominal time between continuous conversions for a data rate
+ *
+ * @param dataRate One of the rate settings from ADS1115_DR_t
+ * @return Sample period in us
+ */
+uint32_t ADS1115_Traits::samplePeriod(ADS1115_DR_t dataRate)
+{
+	if (dataRate == ADS1115_DR_8) { return 125000; }
+	if (dataRate == ADS1115_DR_16) { return 62500; }
+	if (dataRate == ADS1115_DR_32) { return 31250; }
+	if (dataRate == ADS1115_DR_64) { return 15625; }
+	if (dataRate == ADS1115_DR_128) { return 7813; }
+	if (dataRate == ADS1115_DR_250) { return 4000; }
+	if (dataRate == ADS1115_DR_475) { return 2105; }
+	return 1163; // ADS1115_DR_860
+}
+
+/**
+ * @brief Get the nominal time between continuous conversions for a data rate
+ *
+ * @param dataRate One of the rate settings from ADS1015_DR_t
+ * @return Sample period in us
+ */
+uint32_t ADS1015_Traits::samplePeriod(ADS1015_DR_t dataRate)
+{
+	if (dataRate == ADS1015_DR_128) { return 7813; }
+	if (dataRate == ADS1015_DR_250) { return 4000; }
+	if (dataRate == ADS1015_DR_490) { return 2041; }
+	if (dataRate == ADS1015_DR_920) { return 1087; }
+	if (dataRate == ADS1015_DR_1600) { return 625; }
+	if (dataRate == ADS1015_DR_2400) { return 417; }
+	return 303; // ADS1015_DR_3300
 }
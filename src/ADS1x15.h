@@ -8,9 +8,18 @@
 #ifndef __ADS1x15_h_
 #define __ADS1x15_h_
 
+#ifdef ARDUINO
 #include <Arduino.h>
-#include <Wire.h>
-#include <wireUtil.h>
+#else
+#include "ADS1x15Host.h"
+#endif
+#include "ADS1x15Transport.h"
+
+#if defined(ARDUINO_ARCH_ESP32)
+#define ADS1x15_ISR_ATTR IRAM_ATTR
+#else
+#define ADS1x15_ISR_ATTR
+#endif
 
 enum ADS1x15_Register_t
 {
@@ -106,6 +115,31 @@ enum ADS1x15_QUE_t
 	QUE_DISABLE = 0x3
 };
 
+enum ADS1x15_WAIT_t: uint8_t
+{
+	WAIT_DELAY, // wait for the worst case conversion time
+	WAIT_OS_POLL, // poll the OS bit of the config register
+	WAIT_RDY_PIN // wait for the ALERT/RDY pin interrupt
+};
+
+// full scale range for each gain setting, indexed by ADS1x15_GAIN_t >> 9
+static const uint16_t ADS1x15_fullScaleMillivolts[8] = {6144, 4096, 2048, 1024, 512, 256, 256, 256};
+
+enum ADS1x15_FILTER_t
+{
+	FILTER_BOXCAR, // average of the samples, same units as a single read
+	FILTER_DECIMATE, // sum of 4^k samples scaled to k extra bits of resolution
+	FILTER_EMA // exponential moving average kept between calls
+};
+
+enum ADS1x15_READ_t
+{
+	READ_IDLE, // no read started
+	READ_BUSY, // conversion in progress
+	READ_DONE, // result available from getResult()
+	READ_TIMEOUT // the conversion did not finish within timeoutTime
+};
+
 typedef ADS1x15_GAIN_t ADS1015_GAIN_t;
 typedef ADS1x15_GAIN_t ADS1115_GAIN_t;
 
@@ -114,27 +148,194 @@ static const uint16_t ADS1x15_defaultConfig = 0x8583; // default startup state (
 static const uint8_t ADS1x15_defaultAddress = 0x48;
 
 /**
- * @brief Foundation class for the ADS1015 and ADS1115 ADCs
+ * @brief Timestamped conversion result from the stream buffer
  */
-class ADS1x15: public wireUtil<ADS1x15_Register_t, uint16_t>
+struct ADS1x15_Sample
+{
+	uint32_t timestamp; // micros() at the start (scheduled) or end (ALERT/RDY) of the conversion
+	uint16_t mux; // ADS1x15_MUX_t of the input
+	int16_t raw; // converted value
+};
+
+/**
+ * @brief Precompiled settings for one input, see ADS1x15T::makeProfile()
+ */
+struct ADS1x15_ChannelProfile
+{
+	uint16_t config; // complete CONFIG_REG value including the OS bit
+	uint32_t delay; // worst case conversion time in us
+	float scale; // V per LSB, calibration applied
+	uint32_t microvoltScale; // uV per LSB in Q16.16, calibration applied
+};
+
+static const uint8_t ADS1x15_maxScanEntries = 8; // one for each MUX setting
+
+/**
+ * @brief A batch of single ended and differential inputs converted by one scan
+ * @details The results are signed, so differential inputs and single ended
+ * inputs slightly below ground keep their sign.
+ */
+class ADS1x15_ScanSet
 {
 public:
-	using wireUtil::begin;
-	ADS1x15()
+	ADS1x15_ScanSet(): count(0) {}
+	/**
+	 * @brief Add an input at the end of the set
+	 *
+	 * @param mux The configuration of the MUX
+	 * @return True if there was room for the input
+	 */
+	bool add(ADS1x15_MUX_t mux)
 	{
-		timeoutTime = 1000UL;
-		timeoutFlag = false;
-		calibration[0] = 1.0;
-		calibration[1] = 1.0;
-		calibration[2] = 1.0;
-		calibration[3] = 1.0;
-		configRegister = ADS1x15_defaultConfig;
-		currentGain = GAIN_2; // this needs to match the defaultConfig configuration
+		if (count >= ADS1x15_maxScanEntries) { return false; }
+		muxList[count] = mux;
+		result[count++] = 0;
+		return true;
 	}
+	/**
+	 * @brief Remove all inputs
+	 */
+	inline void clear() {count = 0;}
+	/**
+	 * @brief Get the number of inputs
+	 *
+	 * @return Number of inputs
+	 */
+	inline uint8_t size() const {return count;}
+	/**
+	 * @brief Get the MUX setting of an entry
+	 *
+	 * @param i Entry in the order added
+	 * @return The configuration of the MUX
+	 */
+	inline ADS1x15_MUX_t mux(uint8_t i) const {return muxList[i];}
+	/**
+	 * @brief Get the result of an entry from the last scan
+	 *
+	 * @param i Entry in the order added
+	 * @return The converted value
+	 */
+	inline int16_t value(uint8_t i) const {return result[i];}
+	inline const ADS1x15_MUX_t *entries() const {return muxList;}
+	inline int16_t *results() {return result;}
+
+private:
+	ADS1x15_MUX_t muxList[ADS1x15_maxScanEntries];
+	int16_t result[ADS1x15_maxScanEntries];
+	uint8_t count;
+};
+
+/**
+ * @brief Progress of a non-blocking scan, see ADS1x15::scanBegin()
+ */
+struct ADS1x15_ScanCursor
+{
+	const ADS1x15_MUX_t *list;
+	int16_t *out;
+	uint8_t count;
+	uint8_t index; // next result to collect
+};
+
+static const uint8_t ADS1x15_pointerUnknown = 0xFF;
+
+static const uint16_t ADS1x15_unityTimingTrim = 4096; // conversion time scale in Q4.12
+static const uint16_t ADS1x15_maxTimingTrim = 8192;
+static const uint16_t ADS1x15_slowPeriodTrim = 4506; // 1.1 in Q4.12, the data rate is within 10% of nominal
+
+// Define ADS1x15_LEAN for small RAM targets: the calibration factors are kept
+// in Q4.12 (0 - 16, rounded to 1/4096) instead of float, the scale tables are
+// replaced by integer math on every conversion, and auto ranging, the
+// scheduler, startRead()/poll(), the FILTER_EMA state and the built in scan
+// cursor are left out. Non-blocking scans use a caller owned ADS1x15_ScanCursor.
+// Lean builds also drop calibrateTiming() (timed waits and streams use the
+// worst case conversion time), setLock(), setIdleHook(), the enableAlertPin()
+// hook, ALERT/RDY edge timestamps and HS-mode.
+#ifdef ADS1x15_LEAN
+static const uint16_t ADS1x15_unityCalibration = 4096; // calibration factor scale in Q4.12
+#endif
+
+// Define ADS1x15_ENABLE_STATS (e.g. with a build flag) to collect the
+// counters returned by getStats(); otherwise they compile to nothing.
+#ifdef ADS1x15_ENABLE_STATS
+#define ADS1x15_STAT(x) x
+/**
+ * @brief Instrumentation counters, see ADS1x15::getStats()
+ */
+struct ADS1x15_Stats
+{
+	uint32_t transactions; // bus transfers started by the driver
+	uint32_t bytes; // bytes on the bus, including address bytes
+	uint32_t configWritesSkipped; // config writes avoided in continuous mode
+	uint32_t waitMicros; // time spent waiting for conversions
+	uint32_t conversions; // conversions with a measured latency
+	uint32_t latencyMin; // us from config write to result read
+	uint32_t latencyMax;
+	uint32_t latencySum; // divide by conversions for the average
+	uint16_t timeouts; // bus errors and conversion timeouts
+	uint16_t overruns; // samples dropped because the stream buffer was full
+};
+#else
+#define ADS1x15_STAT(x)
+#endif
+
+static const uint8_t ADS1x15_maxAlertPins = 4; // one for each possible address
+
+// Shortest conversion time in us for which a scan reads the previous result
+// while the next conversion runs; faster rates may finish before the read does.
+static const uint32_t ADS1x15_pipelineMinDelay = 1000;
+
+/**
+ * @brief Foundation class for the ADS1015 and ADS1115 ADCs
+ * @details Holds everything that does not depend on the chip type. The chip
+ * is described by the number of bits the result is left justified in the
+ * conversion register, so no virtual functions are needed.
+ */
+class ADS1x15
+{
+public:
 	/**
 	 * @brief Initialize the chip at the default address
 	 */
 	void begin() {begin(ADS1x15_defaultAddress);}
+	void begin(uint8_t);
+	void begin(uint8_t, uint32_t);
+	/**
+	 * @brief Select the bus used by this chip, before calling begin()
+	 *
+	 * @param bus Transport to use, ADS1x15_wireTransport by default
+	 */
+	inline void setTransport(ADS1x15_Transport &bus) {transport = &bus;}
+	/**
+	 * @brief Set a lock held for each complete blocking read on this chip
+	 * @details Guards the shared configuration and the write/wait/read sequence
+	 * when several tasks use the same chip. The bus itself is only locked per
+	 * transfer (see ADS1x15_Transport::setLock()), so other chips can use it
+	 * while a conversion is running. The non-blocking calls are not locked.
+	 *
+	 * @param lock Lock to use, NULL for none
+	 */
+#ifndef ADS1x15_LEAN
+	inline void setLock(ADS1x15_Lock *lock) {deviceLock = lock;}
+#endif
+	/**
+	 * @brief Check if a bus error or conversion timeout has happened
+	 *
+	 * @return True if an error was recorded since the last clearTimeout()
+	 */
+	inline bool timedOut() {return timeoutFlag;}
+	/**
+	 * @brief Clear the error flag read by timedOut()
+	 */
+	inline void clearTimeout() {timeoutFlag = false;}
+#ifdef ADS1x15_ENABLE_STATS
+	/**
+	 * @brief Get the instrumentation counters
+	 *
+	 * @return Counters since the last resetStats()
+	 */
+	inline const ADS1x15_Stats &getStats() {return stats;}
+	void resetStats();
+#endif
 	/**
 	 * @brief Get the hardware address from the logical address of the chip
 	 *
@@ -144,15 +345,197 @@ public:
 	inline uint8_t addressIndex(uint8_t a) {return a + ADS1x15_defaultAddress;}
 	void setCalibration(float);
 	void setCalibration(uint8_t, float);
+	void setCalibration(ADS1x15_MUX_t, float);
 	float resistorDivider(float, float);
 	void setGain(ADS1x15_GAIN_t);
+	/**
+	 * @brief Get the gain of the programmable gain amplifier
+	 *
+	 * @return Gain value from ADS1x15_GAIN_t
+	 */
+#ifdef ADS1x15_LEAN
+	inline ADS1x15_GAIN_t getGain() {return (ADS1x15_GAIN_t)(configRegister & ADS1x15_GAIN_MASK);}
+#else
+	inline ADS1x15_GAIN_t getGain() {return currentGain;}
+#endif
+#ifndef ADS1x15_LEAN
+	/**
+	 * @brief Get the gain used for the last read of an input
+	 * @details Differs from getGain() only with auto ranging enabled.
+	 *
+	 * @param mux The configuration of the MUX
+	 * @return Gain value from ADS1x15_GAIN_t
+	 */
+	inline ADS1x15_GAIN_t getGain(ADS1x15_MUX_t mux)
+	{
+		return autoRange ? (ADS1x15_GAIN_t)(readGain[muxIndex(mux)] << 9) : currentGain;
+	}
+#endif
+	/**
+	 * @brief Get the data rate bits of the current configuration
+	 *
+	 * @return Data rate bits as in ADS1115_DR_t / ADS1015_DR_t
+	 */
+	inline uint16_t getDataRate() {return configRegister & ADS1x15_DR_MASK;}
+#ifndef ADS1x15_LEAN
+	void setAutoRange(bool);
+#endif
+#ifndef ADS1x15_LEAN
+	uint32_t calibrateTiming(uint8_t = 4);
+	/**
+	 * @brief Return to the worst case conversion times, call setDataRate() afterwards
+	 */
+	inline void clearTimingCalibration()
+	{
+		timingTrim = ADS1x15_unityTimingTrim;
+		periodTrim = ADS1x15_slowPeriodTrim;
+	}
+#endif
+	int16_t read(const ADS1x15_ChannelProfile &);
+	float readVoltage(const ADS1x15_ChannelProfile &);
+	int32_t readMicrovolts(const ADS1x15_ChannelProfile &);
 	float getFullScaleV(uint8_t);
 	void setComparatorMode(ADS1x15_COMP_MODE_t);
 	void setComparatorPolarity(ADS1x15_COMP_POL_t);
 	void setComparatorLatch(ADS1x15_COMP_LAT_t);
+	void setConversionMode(ADS1x15_MODE_t);
+	/**
+	 * @brief Set how the end of a conversion is detected
+	 *
+	 * @param mode Method from ADS1x15_WAIT_t
+	 */
+	inline void setCompletionMode(ADS1x15_WAIT_t mode) {waitMode = mode;}
+#ifndef ADS1x15_LEAN
+	/**
+	 * @brief Set a function called repeatedly while a blocking read waits
+	 * @details Use it to put the MCU into a light sleep between the start of a
+	 * conversion and the ALERT/RDY interrupt (WAIT_RDY_PIN), or to yield.
+	 *
+	 * @param hook Function to call, NULL for a busy wait
+	 */
+	inline void setIdleHook(void (*hook)()) {idleHook = hook;}
+	/**
+	 * @brief Call the idle hook set with setIdleHook(), if any
+	 */
+	inline void idle() {if (idleHook != NULL) { idleHook(); }}
+	bool enableAlertPin(uint8_t, void (*)() = NULL);
+#else
+	/**
+	 * @brief Idle hooks are not available in lean builds
+	 */
+	inline void idle() {}
+	bool enableAlertPin(uint8_t);
+#endif
+	void disableAlertPin();
+	bool alertTriggered();
+	bool enableConversionReadyPin(uint8_t);
+	void disableConversionReadyPin();
+	void setComparatorQueue(ADS1x15_QUE_t);
+	void setThresholds(int16_t, int16_t);
+	void setThresholdVoltage(uint8_t, float, float);
+	void startConversion(ADS1x15_MUX_t);
+	void startConversion(const ADS1x15_ChannelProfile &);
+	void startSingleShot(ADS1x15_MUX_t);
+	bool conversionReady();
+	int16_t readConversion();
 	int16_t analogRead(ADS1x15_MUX_t);
-	uint16_t analogRead(uint8_t);
+	int16_t analogRead(uint8_t);
+#ifndef ADS1x15_LEAN
+	void startRead(ADS1x15_MUX_t);
+	ADS1x15_READ_t poll();
+	int16_t getResult();
+#endif
+#ifdef ADS1x15_RTOS
+	int16_t analogReadRTOS(ADS1x15_MUX_t);
+#endif
+	void startContinuous(ADS1x15_MUX_t, int16_t *, uint8_t);
+	/**
+	 * @brief Put the chip in continuous conversion mode without streaming
+	 *
+	 * @param mux The configuration of the MUX
+	 */
+	inline void startContinuous(ADS1x15_MUX_t mux) {startContinuous(mux, (int16_t *)NULL, 0);}
+	void startContinuous(ADS1x15_MUX_t, ADS1x15_Sample *, uint8_t);
+	void stopContinuous();
+#ifndef ADS1x15_LEAN
+	void startScheduled(const ADS1x15_MUX_t *, uint8_t, uint32_t, ADS1x15_Sample *, uint8_t);
+	void stopScheduled();
+	void timerTick();
+#endif
+	bool update();
+	void harvest();
+	uint8_t available();
+	int16_t readBuffered();
+	bool readSample(ADS1x15_Sample &);
+	/**
+	 * @brief Get the number of samples dropped because the stream buffer was full
+	 *
+	 * @return Number of dropped samples
+	 */
+	inline uint16_t getOverruns() {return streamOverruns;}
+#ifndef ADS1x15_LEAN
+	/**
+	 * @brief Get the largest delay between a scheduled tick and the start of its conversion
+	 *
+	 * @return Delay in us since startScheduled()
+	 */
+	inline uint32_t getScheduleLateness() {return scheduleLateness;}
+#endif
+	void scan(const ADS1x15_MUX_t *, uint8_t, int16_t *);
+	void scanBegin(ADS1x15_ScanCursor &, const ADS1x15_MUX_t *, uint8_t, int16_t *);
+	bool scanUpdate(ADS1x15_ScanCursor &);
+	/**
+	 * @brief Convert every input of a scan set, see scan()
+	 *
+	 * @param set Inputs to convert, results are stored in the set
+	 */
+	inline void scan(ADS1x15_ScanSet &set) {scan(set.entries(), set.size(), set.results());}
+	/**
+	 * @brief Start a non-blocking scan of a scan set with a caller owned cursor
+	 *
+	 * @param cursor Scan progress, pass to scanUpdate()
+	 * @param set Inputs to convert, results are stored in the set
+	 */
+	inline void scanBegin(ADS1x15_ScanCursor &cursor, ADS1x15_ScanSet &set)
+	{
+		scanBegin(cursor, set.entries(), set.size(), set.results());
+	}
+#ifndef ADS1x15_LEAN
+	/**
+	 * @brief Start a non-blocking scan with the chip's own cursor, completed by scanUpdate()
+	 *
+	 * @param list MUX configurations to convert, in order
+	 * @param n Number of entries in list
+	 * @param out Results, one per entry in list
+	 */
+	inline void scanBegin(const ADS1x15_MUX_t *list, uint8_t n, int16_t *out) {scanBegin(scanCursor, list, n, out);}
+	/**
+	 * @brief Advance the scan started by scanBegin(const ADS1x15_MUX_t *, uint8_t, int16_t *)
+	 *
+	 * @return True once all results are in the output array
+	 */
+	inline bool scanUpdate() {return scanUpdate(scanCursor);}
+	/**
+	 * @brief Start a non-blocking scan of a scan set, see scanBegin()
+	 *
+	 * @param set Inputs to convert, results are stored in the set
+	 */
+	inline void scanBegin(ADS1x15_ScanSet &set) {scanBegin(scanCursor, set);}
+#endif
+	int32_t oversample(ADS1x15_MUX_t, uint8_t, ADS1x15_FILTER_t = FILTER_BOXCAR);
+#ifndef ADS1x15_LEAN
+	/**
+	 * @brief Restart the moving average used by FILTER_EMA
+	 */
+	inline void resetFilter() {filterValid = false;}
+#endif
 	float analogReadVoltage(uint8_t);
+	int32_t analogReadMicrovolts(uint8_t);
+	int32_t analogReadMicroamps(uint8_t, uint16_t = 100);
+	void convertToVolts(const int16_t *, float *, size_t, uint8_t);
+	void convertToMicrovolts(const int16_t *, int32_t *, size_t, uint8_t);
+	void convertToVolts(const ADS1x15_ScanSet &, float *);
+	void convertToMicrovolts(const ADS1x15_ScanSet &, int32_t *);
 	float analogReadCurrent(uint8_t, float = 100.0);
 	float analogRead420(uint8_t, float = 100.0);
 	/**
@@ -161,71 +544,436 @@ public:
 	 * @param ch Channel to get
 	 * @return Correction factor
 	 */
-	inline float getCalibration(uint8_t ch) {return calibration[ch % 4];}
-	virtual uint8_t getADCbits() {return 0;}
-	virtual uint16_t getFullScaleBits() {return 0;}
+	inline float getCalibration(uint8_t ch) {return calibrationFactor(channelIndex(ch));}
+	/**
+	 * @brief Get the calibration factor of a single ended or differential input
+	 *
+	 * @param mux The configuration of the MUX
+	 * @return Correction factor
+	 */
+	inline float getCalibration(ADS1x15_MUX_t mux) {return calibrationFactor(muxIndex(mux));}
+	/**
+	 * @brief Get the number of bits of the current ADC
+	 *
+	 * @return Number of bits
+	 */
+	inline uint8_t getADCbits() {return 16 - conversionShift;}
+	/**
+	 * @brief Get the full scale binary output for the chip
+	 *
+	 * @return Full scale output
+	 */
+	inline uint16_t getFullScaleBits() {return 0x7FFF >> conversionShift;}
 
 protected:
+	explicit ADS1x15(uint8_t shift)
+	{
+		conversionShift = shift;
+#ifdef ARDUINO
+		transport = &ADS1x15_wireTransport;
+#else
+		transport = NULL; // host builds must call setTransport()
+#endif
+#ifndef ADS1x15_LEAN
+		deviceLock = NULL;
+		highSpeed = false;
+#endif
+		i2cAddress = ADS1x15_defaultAddress;
+		pointerRegister = ADS1x15_pointerUnknown;
+		ADS1x15_STAT(resetStats());
+#ifndef ADS1x15_LEAN
+		timeoutTime = 1000UL;
+#endif
+		timeoutFlag = false;
+		for (uint8_t i = 0; i < 8; i++) { storeCalibration(i, 1.0); }
+		configRegister = ADS1x15_defaultConfig;
+#ifndef ADS1x15_LEAN
+		currentGain = GAIN_2; // this needs to match the defaultConfig configuration
+#endif
+		waitMode = WAIT_DELAY;
+		conversionDelay = 0;
+		conversionStart = 0;
+#ifndef ADS1x15_LEAN
+		timingTrim = ADS1x15_unityTimingTrim;
+		samplePeriod = 0;
+		periodTrim = ADS1x15_slowPeriodTrim;
+		pendingDelay = 0;
+		alertHook = NULL;
+		idleHook = NULL;
+		alertTime = 0;
+		streamLock = NULL;
+#else
+		streamLocked = false;
+#endif
+		alertSlot = ADS1x15_maxAlertPins;
+		sampleReady = false;
+		alertFlag = false;
+		resetStream(0);
+#ifndef ADS1x15_LEAN
+		scheduleList = NULL;
+		scheduleCount = 0;
+		scheduleLateness = 0;
+		tickPending = false;
+		readState = READ_IDLE;
+		readResultValue = 0;
+		readStart = 0;
+		scanCursor.list = NULL;
+		scanCursor.out = NULL;
+		scanCursor.count = 0;
+		scanCursor.index = 0;
+		filterState = 0;
+		filterValid = false;
+		autoRange = false;
+#endif
+#ifdef ADS1x15_RTOS
+		waitingTask = NULL;
+#endif
+		deviceConfig = 0;
+		deviceConfigValid = false;
+	}
+	uint8_t conversionShift;
+	ADS1x15_Transport *transport;
+#ifdef ADS1x15_LEAN
+	static constexpr ADS1x15_Lock *deviceLock = NULL; // no device lock in lean builds
+	static constexpr bool highSpeed = false;
+#else
+	ADS1x15_Lock *deviceLock;
+#endif
+#ifdef ADS1x15_LEAN
+	static constexpr uint16_t timeoutTime = 1000; // ms
+#else
+	unsigned long timeoutTime; // ms
+#endif
+#ifdef ADS1x15_ENABLE_STATS
+	ADS1x15_Stats stats;
+	bool latencyPending; // a conversion was started and its result not read yet
+	uint32_t latencyStart; // micros() when that conversion was started
+#endif
+	/**
+	 * @brief Record a bus error or conversion timeout
+	 */
+	inline void flagTimeout()
+	{
+		timeoutFlag = true;
+		ADS1x15_STAT(stats.timeouts++);
+	}
+	uint8_t i2cAddress;
+	uint8_t pointerRegister; // register the chip's address pointer is parked on
+#ifndef ADS1x15_LEAN
+	bool highSpeed; // keep the bus in HS-mode by never sending a STOP
+#endif
+	bool selectRegister(ADS1x15_Register_t);
+	uint16_t readRegister(ADS1x15_Register_t);
+	uint16_t readResult();
+	bool writeRegister(ADS1x15_Register_t, uint16_t);
 	uint16_t configRegister;
-	ADS1x15_GAIN_t currentGain;
+#ifndef ADS1x15_LEAN
+	ADS1x15_GAIN_t currentGain; // lean builds take it from configRegister, see getGain()
+#endif
+	ADS1x15_WAIT_t waitMode;
 	uint32_t conversionDelay;
-	float calibration[4];
-	virtual inline uint16_t shiftConversion(uint16_t c) {return c;}
+	uint32_t conversionStart;
+#ifdef ADS1x15_LEAN
+	/**
+	 * @brief Get the time between two continuous conversions, the worst case conversion time in lean builds
+	 *
+	 * @return Sample period in us
+	 */
+	inline uint32_t streamPeriod() {return conversionDelay;}
+	static inline uint32_t trimDelay(uint32_t delay) {return delay;}
+	/**
+	 * @brief Get the conversion time of the conversion in progress
+	 * @details beginConversion() moves conversionStart so that every
+	 * conversion is due conversionDelay after it.
+	 *
+	 * @return Conversion time in us
+	 */
+	inline uint32_t pendingTime() {return conversionDelay;}
+#else
+	uint16_t timingTrim; // measured / worst case conversion time in Q4.12
+	uint32_t samplePeriod; // nominal time between continuous conversions in us
+	uint16_t periodTrim; // measured (or slowest in spec) / nominal sample period in Q4.12
+	/**
+	 * @brief Get the time between two continuous conversions of this chip
+	 *
+	 * @return Sample period in us, that of the slowest chip in spec until calibrateTiming() has run
+	 */
+	inline uint32_t streamPeriod() {return (samplePeriod * periodTrim) >> 12;}
+	uint32_t trimDelay(uint32_t);
+	uint32_t pendingDelay; // conversion time of the conversion in progress
+	/**
+	 * @brief Get the conversion time of the conversion in progress
+	 *
+	 * @return Conversion time in us
+	 */
+	inline uint32_t pendingTime() {return pendingDelay;}
+#endif
+#ifdef ADS1x15_LEAN
+	uint16_t calibration[8]; // Q4.12, indexed by muxIndex()
+	inline float calibrationFactor(uint8_t i) {return calibration[i] / (float)ADS1x15_unityCalibration;}
+#else
+	float calibration[8]; // indexed by muxIndex()
+	inline float calibrationFactor(uint8_t i) {return calibration[i];}
+#endif
+	void storeCalibration(uint8_t, float);
+	uint8_t alertPin;
+	uint8_t alertSlot;
+	volatile bool sampleReady;
+	volatile bool alertFlag;
+#ifndef ADS1x15_LEAN
+	void (*alertHook)();
+	void (*idleHook)();
+	volatile uint32_t alertTime; // micros() of the last ALERT/RDY edge
+#endif
+	void *streamData; // int16_t raw register values or ADS1x15_Sample records
+	/**
+	 * @brief Get the raw register value buffer of a stream without timestamps
+	 *
+	 * @return Buffer given to startContinuous()
+	 */
+	inline int16_t *streamBuffer() {return (int16_t *)streamData;}
+	/**
+	 * @brief Get the record buffer of a timestamped stream
+	 *
+	 * @return Buffer given to startContinuous() or startScheduled(), NULL for other streams
+	 */
+	inline ADS1x15_Sample *streamRecords() {return streamTimestamped ? (ADS1x15_Sample *)streamData : NULL;}
+	uint8_t streamSize;
+	volatile uint8_t streamHead; // written only by the producer (harvest)
+	volatile uint8_t streamTail; // written only by the consumer (readBuffered)
+	uint16_t streamOverruns;
+	void resetStream(uint8_t);
+	bool streamFull();
+	ADS1x15_Sample *streamSlot();
+	void streamCommit();
+	void releaseStreamLock();
+#ifndef ADS1x15_LEAN
+	const ADS1x15_MUX_t *scheduleList;
+	uint8_t scheduleCount;
+	uint8_t scheduleIndex; // next input to convert
+	uint32_t schedulePeriod; // us, 0 when ticked by timerTick()
+	uint32_t nextTick;
+	uint32_t scheduleTime; // start time of the conversion in progress
+	uint32_t scheduleLateness; // largest tick to conversion start delay in us
+	ADS1x15_MUX_t scheduleMux;
+	bool scheduleBusy;
+	volatile bool tickPending;
+	volatile uint32_t tickTime;
+	bool scheduleUpdate();
+	ADS1x15_READ_t readState;
+	int16_t readResultValue;
+	uint32_t readStart; // millis() when startRead() was called
+#endif
+#ifdef ADS1x15_RTOS
+	TaskHandle_t volatile waitingTask; // task blocked in analogReadRTOS(), notified by the ALERT/RDY interrupt
+#endif
+	uint16_t deviceConfig; // last value written to CONFIG_REG
+#ifdef ADS1x15_LEAN
+	// packed into one byte, none of them is written from an interrupt
+	bool timeoutFlag: 1;
+	bool deviceConfigValid: 1;
+	bool streamTimestamped: 1; // streamData holds ADS1x15_Sample records
+	bool streamPending: 1; // readAsync() into the stream buffer head in progress
+	bool streamLocked: 1; // the transport's bus lock is held until that read has completed
+	bool streamPrimed: 1; // first continuous conversion collected, later ones are due every streamPeriod()
+#else
+	bool timeoutFlag;
+	bool deviceConfigValid;
+	bool streamTimestamped; // streamData holds ADS1x15_Sample records
+	bool streamPending; // readAsync() into the stream buffer head in progress
+	ADS1x15_Lock *streamLock; // bus lock held until that read has completed
+	bool streamPrimed; // first continuous conversion collected, later ones are due every streamPeriod()
+#endif
+	bool writeConfig(uint16_t);
+#ifdef ADS1x15_LEAN
+	uint32_t microvoltScaleOf(uint8_t);
+	inline float voltScaleOf(uint8_t i) {return microvoltScaleOf(i) * (float)(0.000001 / 65536.0);}
+#else
+	float voltScale[8]; // V per LSB, calibration applied, indexed by muxIndex()
+	uint32_t microvoltScale[8]; // uV per LSB in Q16.16, calibration applied
+	inline uint32_t microvoltScaleOf(uint8_t i) {return microvoltScale[i];}
+	inline float voltScaleOf(uint8_t i) {return voltScale[i];}
+#endif
+	/**
+	 * @brief Get the calibration and scale index of a MUX setting
+	 *
+	 * @param mux The configuration of the MUX
+	 * @return 0 - 3 for the differential inputs, 4 - 7 for SE0 - SE3
+	 */
+	static inline uint8_t muxIndex(ADS1x15_MUX_t mux) {return (uint16_t)mux >> 12;}
+	/**
+	 * @brief Get the calibration and scale index of a single ended channel
+	 *
+	 * @param ch Channel number
+	 * @return Index for SE0 - SE3
+	 */
+	static inline uint8_t channelIndex(uint8_t ch) {return 4 + ch % 4;}
+	void updateScale();
+	void updateScale(uint8_t);
+	void computeScale(ADS1x15_GAIN_t, float, float &, uint32_t &);
+	void compileProfile(ADS1x15_ChannelProfile &, ADS1x15_MUX_t, ADS1x15_GAIN_t, uint16_t, uint32_t);
+	void beginConversion(uint16_t, uint32_t);
+	static int32_t applyScale(int16_t, uint32_t);
+	void scanStep(ADS1x15_ScanCursor &);
+#ifndef ADS1x15_LEAN
+	ADS1x15_ScanCursor scanCursor; // used by scanBegin() without a cursor argument
+	int32_t filterState; // FILTER_EMA state in Q8
+	bool filterValid;
+	bool autoRange;
+	uint8_t rangeGain[8]; // auto range gain for the next read of each MUX setting, as ADS1x15_GAIN_t >> 9
+	uint8_t readGain[8]; // gain of the last read of each MUX setting, as rangeGain
+	int16_t autoRangeRead(ADS1x15_MUX_t, ADS1x15_GAIN_t &);
+#endif
+	bool waitForConversion();
+	int16_t voltageToCode(uint8_t, float);
+	/**
+	 * @brief Interrupt handler for the ALERT/RDY pin
+	 */
+	inline void handleAlert()
+	{
+#ifndef ADS1x15_LEAN
+		alertTime = micros();
+#endif
+		sampleReady = true;
+		alertFlag = true;
+#ifndef ADS1x15_LEAN
+		if (alertHook != NULL) { alertHook(); }
+#endif
+#ifdef ADS1x15_RTOS
+		if (waitingTask != NULL)
+		{
+			BaseType_t woken = pdFALSE;
+			vTaskNotifyGiveFromISR(waitingTask, &woken);
+			if (woken) { portYIELD_FROM_ISR(); }
+		}
+#endif
+	}
+	static ADS1x15 *alertOwner[ADS1x15_maxAlertPins];
+	static void alertISR0();
+	static void alertISR1();
+	static void alertISR2();
+	static void alertISR3();
+	void applyDataRate(uint16_t, uint32_t, uint32_t);
+	/**
+	 * @brief Right justify and sign extend the conversion register
+	 *
+	 * @param c Raw register value
+	 * @return Signed result
+	 */
+	inline int16_t shiftConversion(uint16_t c) {return (int16_t)c >> conversionShift;}
 };
 
 /**
- * @brief Interface class for the ADS1115 analog to digital converter
+ * @brief Chip description for the ADS1115
+ */
+struct ADS1115_Traits
+{
+	typedef ADS1115_DR_t DataRate;
+	static constexpr uint8_t shift() {return 0;}
+	static constexpr DataRate defaultDataRate() {return ADS1115_DR_128;}
+	static constexpr DataRate fastestDataRate() {return ADS1115_DR_860;}
+	static uint32_t conversionDelay(DataRate);
+	static uint32_t samplePeriod(DataRate);
+};
+
+/**
+ * @brief Chip description for the ADS1015
  */
-class ADS1115: public ADS1x15
+struct ADS1015_Traits
+{
+	typedef ADS1015_DR_t DataRate;
+	static constexpr uint8_t shift() {return 4;}
+	static constexpr DataRate defaultDataRate() {return ADS1015_DR_1600;}
+	static constexpr DataRate fastestDataRate() {return ADS1015_DR_3300;}
+	static uint32_t conversionDelay(DataRate);
+	static uint32_t samplePeriod(DataRate);
+};
+
+/**
+ * @brief Interface class for an ADS1x15 chip described by a traits class
+ * @details Replaces the virtual chip hooks, so there is no vtable. The shift
+ * is only a compile time constant in the members below when they are called
+ * on the typed object; the shared read, scan, stream and scale code in
+ * ADS1x15 is compiled once for both chips and uses the result shift stored
+ * in the base as a runtime byte.
+ */
+template <class Chip>
+class ADS1x15T: public ADS1x15
 {
 public:
-	ADS1115()
+	typedef typename Chip::DataRate DataRate;
+	ADS1x15T(): ADS1x15(Chip::shift())
 	{
-		ADS1x15();
-		setDataRate(ADS1115_DR_128);
+		setDataRate(Chip::defaultDataRate());
+		updateScale();
 	}
-	void setDataRate(ADS1115_DR_t);
 	/**
-	 * @brief Get the number of bits of the current ADC
+	 * @brief Set the conversion rate in samples per second
 	 *
-	 * @return Number of bits
+	 * @param dataRate One of the rate settings for the chip
 	 */
-	inline uint8_t getADCbits() {return 16;}
+	inline void setDataRate(DataRate dataRate)
+	{
+		applyDataRate((uint16_t)dataRate, Chip::conversionDelay(dataRate), Chip::samplePeriod(dataRate));
+	}
 	/**
-	 * @brief Get the full scale binary output for the chip
+	 * @brief Build a channel profile for read(const ADS1x15_ChannelProfile &)
 	 *
-	 * @return Full scale output
+	 * @param mux The configuration of the MUX
+	 * @param gain Gain value from ADS1x15_GAIN_t
+	 * @param dataRate One of the rate settings for the chip
+	 * @return Profile with the config word, conversion time and scale precomputed
 	 */
-	inline uint16_t getFullScaleBits() {return 0x7FFF;}
-};
-
-/**
- * @brief Interface class for the ADS1015 analog to digital converter
- */
-class ADS1015: public ADS1x15
-{
-public:
-	ADS1015()
+	inline ADS1x15_ChannelProfile makeProfile(ADS1x15_MUX_t mux, ADS1x15_GAIN_t gain, DataRate dataRate)
+	{
+		ADS1x15_ChannelProfile profile;
+		compileProfile(profile, mux, gain, (uint16_t)dataRate, Chip::conversionDelay(dataRate));
+		return profile;
+	}
+	/**
+	 * @brief Build a single shot profile at the fastest data rate for duty cycled sampling
+	 * @details The shortest conversion keeps the chip out of power-down for the
+	 * least time. The comparator settings are copied from the current
+	 * configuration, so set the thresholds, queue and latch first to have every
+	 * one-shot also raise ALERT when the input leaves the window.
+	 *
+	 * @param mux The configuration of the MUX
+	 * @param gain Gain value from ADS1x15_GAIN_t
+	 * @return Profile for startConversion(const ADS1x15_ChannelProfile &) or read()
+	 */
+	inline ADS1x15_ChannelProfile makeLowPowerProfile(ADS1x15_MUX_t mux, ADS1x15_GAIN_t gain)
 	{
-		ADS1x15();
-		setDataRate(ADS1015_DR_1600);
+		return makeProfile(mux, gain, Chip::fastestDataRate());
 	}
-	void setDataRate(ADS1015_DR_t);
 	/**
 	 * @brief Get the number of bits of the current ADC
 	 *
 	 * @return Number of bits
 	 */
-	inline uint8_t getADCbits() {return 12;}
+	static constexpr uint8_t getADCbits() {return 16 - Chip::shift();}
 	/**
 	 * @brief Get the full scale binary output for the chip
 	 *
 	 * @return Full scale output
 	 */
-	inline uint16_t getFullScaleBits() {return 0x07FF;}
-private:
-	inline uint16_t shiftConversion(uint16_t c) {return c >> 4;}
+	static constexpr uint16_t getFullScaleBits() {return 0x7FFF >> Chip::shift();}
+	/**
+	 * @brief Read the result of the last conversion
+	 *
+	 * @return The converted value
+	 */
+	inline int16_t readConversion() {return (int16_t)readResult() >> Chip::shift();}
 };
 
+/**
+ * @brief Interface class for the ADS1115 analog to digital converter
+ */
+typedef ADS1x15T<ADS1115_Traits> ADS1115;
+
+/**
+ * @brief Interface class for the ADS1015 analog to digital converter
+ */
+typedef ADS1x15T<ADS1015_Traits> ADS1015;
+
 
 #endif // __ADS1115_h_
\ No newline at end of file
@@ -0,0 +1,144 @@
+#include "ADS1x15Bus.h"
+
+/**
+ * @brief Register a chip with the bus
+ *
+ * @param adc Chip to add, already started with begin()
+ * @return True if there was room for the chip
+ */
+bool ADS1x15Bus::add(ADS1x15 &adc)
+{
+	if (deviceCount >= ADS1x15_maxBusDevices) { return false; }
+	device[deviceCount++] = &adc;
+	return true;
+}
+
+/**
+ * @brief Start the same conversion on every chip without waiting
+ *
+ * @param mux The configuration of the MUX
+ * @param out Results, one per chip, filled in by update()
+ */
+void ADS1x15Bus::start(ADS1x15_MUX_t mux, int16_t *out)
+{
+	singleMux = mux;
+	startScan(&singleMux, 1, out);
+}
+
+/**
+ * @brief Start a scan of the same input list on every chip without waiting
+ *
+ * @param list MUX configurations to convert, in order
+ * @param n Number of entries in list
+ * @param out Results, n per chip, filled in by update()
+ */
+void ADS1x15Bus::startScan(const ADS1x15_MUX_t *list, uint8_t n, int16_t *out)
+{
+	for (uint8_t i = 0; i < deviceCount; i++)
+	{
+		device[i]->scanBegin(cursor[i], list, n, out + (uint16_t)i * n);
+	}
+}
+
+/**
+ * @brief Collect results from the chips that have finished
+ *
+ * @return True once every chip has completed its conversions
+ */
+bool ADS1x15Bus::update()
+{
+	bool done = true;
+	for (uint8_t i = 0; i < deviceCount; i++)
+	{
+		if (!device[i]->scanUpdate(cursor[i])) { done = false; }
+	}
+	return done;
+}
+
+/**
+ * @brief Read the same input on every chip
+ *
+ * @param mux The configuration of the MUX
+ * @param out Results, one per chip
+ */
+void ADS1x15Bus::read(ADS1x15_MUX_t mux, int16_t *out)
+{
+	start(mux, out);
+	wait();
+}
+
+/**
+ * @brief Scan the same input list on every chip
+ *
+ * @param list MUX configurations to convert, in order
+ * @param n Number of entries in list
+ * @param out Results, n per chip
+ */
+void ADS1x15Bus::scan(const ADS1x15_MUX_t *list, uint8_t n, int16_t *out)
+{
+	startScan(list, n, out);
+	wait();
+}
+
+/**
+ * @brief Start a single shot conversion on every chip as close together as possible
+ * @details The config words are written back to back with nothing else in
+ * between, so the chips start one register write apart (about 100 us at
+ * 400 kHz, less with setClock() faster). The ADS1x15 has no general call
+ * command that starts a conversion, so this is the tightest grouping
+ * possible. Every chip runs a single shot conversion, also a chip set to
+ * continuous mode. Collect the results with update().
+ *
+ * @param mux The configuration of the MUX
+ * @param set Output, timestamp and skew are set here, the values by update()
+ */
+void ADS1x15Bus::startSynchronized(ADS1x15_MUX_t mux, ADS1x15_SyncSet &set)
+{
+	singleMux = mux;
+	uint32_t first = 0;
+	uint32_t last = 0;
+	for (uint8_t i = 0; i < deviceCount; i++)
+	{
+		cursor[i].list = &singleMux;
+		cursor[i].out = &set.value[i];
+		cursor[i].count = 1;
+		cursor[i].index = 0;
+		device[i]->startSingleShot(mux);
+		last = micros();
+		if (i == 0) { first = last; }
+	}
+	set.timestamp = first;
+	set.skew = last - first;
+}
+
+/**
+ * @brief Read the same input on every chip with a synchronized start
+ *
+ * @param mux The configuration of the MUX
+ * @param set Output with one value per chip and the measured skew
+ */
+void ADS1x15Bus::readSynchronized(ADS1x15_MUX_t mux, ADS1x15_SyncSet &set)
+{
+	startSynchronized(mux, set);
+	wait();
+}
+
+/**
+ * @brief Call update() until all chips are done or timeoutTime ms pass
+ * @details The idle hook of every chip (see ADS1x15::setIdleHook()) is called
+ * between the checks.
+ */
+void ADS1x15Bus::wait()
+{
+	uint32_t start = millis();
+	timeoutFlag = false;
+	while (!update())
+	{
+		if ((millis() - start) > timeoutTime)
+		{
+			timeoutFlag = true;
+			return;
+		}
+		for (uint8_t i = 0; i < deviceCount; i++) { device[i]->idle(); }
+	}
+}
@@ -0,0 +1,71 @@
+/**
+ * @file ADS1x15Bus.h
+ * @author Keegan Morrow
+ * @version 0.0.4
+ * @brief Coordinator for several ADS1x15 chips sharing one I2C bus
+ */
+
+#ifndef __ADS1x15Bus_h_
+#define __ADS1x15Bus_h_
+
+#include "ADS1x15.h"
+
+static const uint8_t ADS1x15_maxBusDevices = 4; // one for each possible address
+
+/**
+ * @brief Results of one synchronized conversion on every chip, see ADS1x15Bus::startSynchronized()
+ */
+struct ADS1x15_SyncSet
+{
+	uint32_t timestamp; // micros() when the first chip started converting
+	uint32_t skew; // us between the start of the first and the last chip
+	int16_t value[ADS1x15_maxBusDevices]; // one per chip, in the order added
+};
+
+/**
+ * @brief Runs conversions on all registered chips at the same time
+ * @details Each chip is started before any result is collected, so the
+ * conversion times overlap instead of adding up. Results are stored per
+ * device: out[device * n + entry].
+ */
+class ADS1x15Bus
+{
+public:
+	ADS1x15Bus()
+	{
+		deviceCount = 0;
+		timeoutTime = 1000UL;
+		timeoutFlag = false;
+	}
+	bool add(ADS1x15 &);
+	/**
+	 * @brief Get the number of registered chips
+	 *
+	 * @return Number of chips
+	 */
+	inline uint8_t size() {return deviceCount;}
+	void start(ADS1x15_MUX_t, int16_t *);
+	void startScan(const ADS1x15_MUX_t *, uint8_t, int16_t *);
+	bool update();
+	void read(ADS1x15_MUX_t, int16_t *);
+	void scan(const ADS1x15_MUX_t *, uint8_t, int16_t *);
+	void startSynchronized(ADS1x15_MUX_t, ADS1x15_SyncSet &);
+	void readSynchronized(ADS1x15_MUX_t, ADS1x15_SyncSet &);
+	/**
+	 * @brief Check if the last blocking read or scan timed out
+	 *
+	 * @return True if a chip did not finish within timeoutTime ms
+	 */
+	inline bool timedOut() {return timeoutFlag;}
+	uint32_t timeoutTime;
+
+private:
+	ADS1x15 *device[ADS1x15_maxBusDevices];
+	ADS1x15_ScanCursor cursor[ADS1x15_maxBusDevices];
+	uint8_t deviceCount;
+	ADS1x15_MUX_t singleMux;
+	bool timeoutFlag;
+	void wait();
+};
+
+#endif // __ADS1x15Bus_h_
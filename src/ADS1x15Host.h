@@ -0,0 +1,43 @@
+/**
+ * @file ADS1x15Host.h
+ * @author Keegan Morrow
+ * @version 0.0.4
+ * @brief Minimal stand-ins for the Arduino functions used by the library, for host builds
+ * @details Only used when ARDUINO is not defined. Pins have no interrupts,
+ * so the ALERT/RDY features report failure; use ADS1x15_SimTransport as the bus.
+ */
+
+#ifndef __ADS1x15Host_h_
+#define __ADS1x15Host_h_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <chrono>
+
+#define INPUT_PULLUP 0x2
+#define CHANGE 1
+#define FALLING 2
+#define RISING 3
+#define NOT_AN_INTERRUPT -1
+#define digitalPinToInterrupt(p) ((void)(p), NOT_AN_INTERRUPT)
+
+inline unsigned long micros()
+{
+	static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(
+	           std::chrono::steady_clock::now() - start).count();
+}
+
+inline unsigned long millis() {return micros() / 1000UL;}
+
+inline void delayMicroseconds(unsigned int us)
+{
+	unsigned long start = micros();
+	while ((micros() - start) < us) {}
+}
+
+inline void pinMode(uint8_t, uint8_t) {}
+inline void attachInterrupt(int, void (*)(), int) {}
+inline void detachInterrupt(int) {}
+
+#endif // __ADS1x15Host_h_
@@ -0,0 +1,79 @@
+/**
+ * @file ADS1x15Lock.h
+ * @author Keegan Morrow
+ * @version 0.0.4
+ * @brief Optional locking for sharing chips and buses between tasks
+ */
+
+#ifndef __ADS1x15Lock_h_
+#define __ADS1x15Lock_h_
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include "ADS1x15Host.h"
+#endif
+
+#if defined(ARDUINO_ARCH_ESP32)
+#define ADS1x15_RTOS
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+#elif defined(ADS1x15_FREERTOS) // define for other FreeRTOS ports
+#define ADS1x15_RTOS
+#include <FreeRTOS.h>
+#include <task.h>
+#include <semphr.h>
+#endif
+
+/**
+ * @brief Mutual exclusion used by ADS1x15_Transport::setLock() and ADS1x15::setLock()
+ * @details The library never takes the same lock twice, so it does not need
+ * to be recursive as long as a bus lock and a device lock are different objects.
+ */
+class ADS1x15_Lock
+{
+public:
+	virtual void lock() = 0;
+	virtual void unlock() = 0;
+};
+
+/**
+ * @brief Holds a lock for the lifetime of the guard, does nothing for NULL
+ */
+class ADS1x15_LockGuard
+{
+public:
+	explicit ADS1x15_LockGuard(ADS1x15_Lock *lock): held(lock)
+	{
+		if (held != NULL) { held->lock(); }
+	}
+	~ADS1x15_LockGuard()
+	{
+		if (held != NULL) { held->unlock(); }
+	}
+
+private:
+	ADS1x15_Lock *held;
+	ADS1x15_LockGuard(const ADS1x15_LockGuard &);
+	ADS1x15_LockGuard &operator=(const ADS1x15_LockGuard &);
+};
+
+#ifdef ADS1x15_RTOS
+/**
+ * @brief FreeRTOS mutex with statically allocated storage
+ */
+class ADS1x15_FreeRTOSMutex: public ADS1x15_Lock
+{
+public:
+	ADS1x15_FreeRTOSMutex() {handle = xSemaphoreCreateMutexStatic(&storage);}
+	void lock() {xSemaphoreTake(handle, portMAX_DELAY);}
+	void unlock() {xSemaphoreGive(handle);}
+
+private:
+	StaticSemaphore_t storage;
+	SemaphoreHandle_t handle;
+};
+#endif
+
+#endif // __ADS1x15Lock_h_
@@ -0,0 +1,119 @@
+#include "ADS1x15Log.h"
+
+/**
+ * @brief Pass bytes to the sink and count them
+ *
+ * @param data Bytes to write
+ * @param length Number of bytes
+ * @return True if the sink took all bytes
+ */
+bool ADS1x15_LogEncoder::emit(const uint8_t *data, size_t length)
+{
+	if (!sink.write(data, length)) { return false; }
+	byteCount += length;
+	return true;
+}
+
+/**
+ * @brief Write the log header with the current settings of a chip
+ * @details Call after setGain(), setDataRate() and setCalibration() so the
+ * decoder can convert the codes back to volts.
+ *
+ * @param adc Chip the samples come from
+ * @param mux Input that will be logged, selects the calibration factor
+ * @return True if the header was written
+ */
+bool ADS1x15_LogEncoder::begin(ADS1x15 &adc, ADS1x15_MUX_t mux)
+{
+	blockCount = 0;
+	byteCount = 0;
+	logMux = mux;
+	uint32_t q = (uint32_t)(adc.getCalibration(mux) * 65536.0 + 0.5);
+	uint8_t header[ADS1x15_logHeaderSize] =
+	{
+		'A', 'D', 'S', 'L', ADS1x15_logVersion, adc.getADCbits(),
+		(uint8_t)((uint16_t)adc.getGain() >> 9), (uint8_t)(adc.getDataRate() >> 5),
+		(uint8_t)((uint16_t)mux >> 12), ADS1x15_logBlockSamples,
+		(uint8_t)q, (uint8_t)(q >> 8), (uint8_t)(q >> 16), (uint8_t)(q >> 24), 0, 0
+	};
+	return emit(header, sizeof(header));
+}
+
+/**
+ * @brief Add one code to the log
+ *
+ * @param code Converted value, e.g. from readBuffered()
+ * @return False if a full block could not be written
+ */
+bool ADS1x15_LogEncoder::write(int16_t code)
+{
+	block[blockCount++] = code;
+	if (blockCount < ADS1x15_logBlockSamples) { return true; }
+	return flush();
+}
+
+/**
+ * @brief Move every buffered sample of a running stream into the log
+ * @details The log holds the single input given to begin(), so stream that
+ * input with startContinuous() or a one entry startScheduled() list. Samples of
+ * other inputs are removed from the buffer and dropped, they would be mixed
+ * into the delta stream with the wrong calibration and could not be told apart
+ * by the decoder.
+ *
+ * @param adc Chip streaming the input given to begin()
+ * @return False if a block could not be written
+ */
+bool ADS1x15_LogEncoder::drain(ADS1x15 &adc)
+{
+	ADS1x15_Sample sample;
+	while (adc.readSample(sample))
+	{
+		if (sample.mux != (uint16_t)logMux) { continue; }
+		if (!write(sample.raw)) { return false; }
+	}
+	return true;
+}
+
+/**
+ * @brief Encode and write the current block, even if it is not full
+ *
+ * @return False if the sink did not take the block
+ */
+bool ADS1x15_LogEncoder::flush()
+{
+	if (blockCount == 0) { return true; }
+	uint32_t largest = 0;
+	for (uint8_t i = 1; i < blockCount; i++)
+	{
+		int32_t delta = (int32_t)block[i] - block[i - 1];
+		uint32_t zigzag = ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31);
+		largest |= zigzag;
+	}
+	uint8_t width = 0;
+	while (largest >> width) { width++; }
+
+	uint8_t out[ADS1x15_LOG_BLOCK_BYTES(ADS1x15_logBlockSamples)];
+	out[0] = blockCount;
+	out[1] = width;
+	out[2] = (uint8_t)block[0];
+	out[3] = (uint8_t)((uint16_t)block[0] >> 8);
+	size_t size = 4;
+	uint32_t bits = 0;
+	uint8_t bitCount = 0;
+	for (uint8_t i = 1; i < blockCount; i++)
+	{
+		int32_t delta = (int32_t)block[i] - block[i - 1];
+		uint32_t zigzag = ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31);
+		bits |= zigzag << bitCount;
+		bitCount += width;
+		while (bitCount >= 8)
+		{
+			out[size++] = (uint8_t)bits;
+			bits >>= 8;
+			bitCount -= 8;
+		}
+	}
+	if (bitCount > 0) { out[size++] = (uint8_t)bits; }
+	blockCount = 0;
+	return emit(out, size);
+}
@@ -0,0 +1,80 @@
+/**
+ * @file ADS1x15Log.h
+ * @author Keegan Morrow
+ * @version 0.0.4
+ * @brief Compact binary logging of raw codes, format in ADS1x15LogFormat.h
+ */
+
+#ifndef __ADS1x15Log_h_
+#define __ADS1x15Log_h_
+
+#include "ADS1x15.h"
+#include "ADS1x15LogFormat.h"
+
+/**
+ * @brief Destination for encoded log data
+ */
+class ADS1x15_LogSink
+{
+public:
+	/**
+	 * @brief Store bytes at the end of the log
+	 *
+	 * @param data Bytes to write
+	 * @param length Number of bytes
+	 * @return True if all bytes were written
+	 */
+	virtual bool write(const uint8_t *data, size_t length) = 0;
+};
+
+#ifdef ARDUINO
+/**
+ * @brief Log sink for any Print, e.g. an SD File or Serial
+ */
+class ADS1x15_PrintSink: public ADS1x15_LogSink
+{
+public:
+	explicit ADS1x15_PrintSink(Print &out): out(out) {}
+	bool write(const uint8_t *data, size_t length) {return out.write(data, length) == length;}
+
+private:
+	Print &out;
+};
+#endif
+
+/**
+ * @brief Delta encodes raw codes into fixed size blocks
+ * @details Steady inputs give small differences between codes, which are
+ * packed at the width of the largest difference in each block. Noise of a
+ * few codes takes 3 to 5 bits per sample instead of 16.
+ */
+class ADS1x15_LogEncoder
+{
+public:
+	explicit ADS1x15_LogEncoder(ADS1x15_LogSink &sink): sink(sink)
+	{
+		blockCount = 0;
+		byteCount = 0;
+		logMux = SE0;
+	}
+	bool begin(ADS1x15 &, ADS1x15_MUX_t);
+	bool write(int16_t);
+	bool drain(ADS1x15 &);
+	bool flush();
+	/**
+	 * @brief Get the size of the log so far
+	 *
+	 * @return Bytes passed to the sink, including the header
+	 */
+	inline uint32_t bytesWritten() {return byteCount;}
+
+private:
+	ADS1x15_LogSink &sink;
+	int16_t block[ADS1x15_logBlockSamples];
+	uint8_t blockCount;
+	uint32_t byteCount;
+	ADS1x15_MUX_t logMux; // the input given to begin(), a log holds one input
+	bool emit(const uint8_t *, size_t);
+};
+
+#endif // __ADS1x15Log_h_
@@ -0,0 +1,140 @@
+/**
+ * @file ADS1x15LogFormat.h
+ * @author Keegan Morrow
+ * @version 0.0.4
+ * @brief Binary sample log format and decoder, usable without Arduino
+ * @details A log is a 16 byte header followed by blocks of up to
+ * blockSamples codes. All fields are little endian.
+ *
+ * Header: "ADSL", version, ADC bits, gain index, data rate index, MUX index,
+ * block samples, calibration (uint32 Q16.16), 2 reserved bytes.
+ *
+ * Block: sample count, delta width in bits, first code (int16), then the
+ * zigzag encoded differences to the previous code, packed LSB first at the
+ * delta width and padded to a whole byte.
+ */
+
+#ifndef __ADS1x15LogFormat_h_
+#define __ADS1x15LogFormat_h_
+
+#include <stdint.h>
+#include <stddef.h>
+
+static const uint8_t ADS1x15_logVersion = 1;
+static const uint8_t ADS1x15_logHeaderSize = 16;
+static const uint8_t ADS1x15_logBlockSamples = 64; // samples per block written by ADS1x15_LogEncoder
+static const uint8_t ADS1x15_logMaxDeltaBits = 17; // zigzag of a full scale step
+
+/**
+ * @brief Maximum size in bytes of an encoded block of n samples
+ */
+#define ADS1x15_LOG_BLOCK_BYTES(n) (4 + (((n) - 1) * ADS1x15_logMaxDeltaBits + 7) / 8)
+
+/**
+ * @brief Settings recorded at the start of a log
+ */
+struct ADS1x15_LogHeader
+{
+	uint8_t adcBits; // 16 for ADS1115, 12 for ADS1015
+	uint8_t gain; // ADS1x15_GAIN_t >> 9
+	uint8_t dataRate; // data rate bits >> 5
+	uint8_t mux; // ADS1x15_MUX_t >> 12
+	uint8_t blockSamples; // largest block in the log
+	uint32_t calibration; // calibration factor in Q16.16
+
+	/**
+	 * @brief Get the input voltage of one code
+	 *
+	 * @return uV per code, calibration applied, as the driver's voltage functions
+	 */
+	float microvoltsPerCode() const
+	{
+		static const uint16_t fullScale[8] = {6144, 4096, 2048, 1024, 512, 256, 256, 256};
+		// full scale maps to the largest code, see ADS1x15::getFullScaleBits()
+		return fullScale[gain & 0x7] * 1000.0f / (float)((1UL << (adcBits - 1)) - 1) * (calibration / 65536.0f);
+	}
+};
+
+/**
+ * @brief Reads a log written by ADS1x15_LogEncoder from memory
+ */
+class ADS1x15_LogDecoder
+{
+public:
+	/**
+	 * @param data Log contents
+	 * @param length Number of bytes in data
+	 */
+	ADS1x15_LogDecoder(const uint8_t *data, size_t length): data(data), length(length), position(0) {}
+
+	/**
+	 * @brief Read the log header, call once before readBlock()
+	 *
+	 * @param header Output
+	 * @return False if the data is not a log of a known version
+	 */
+	bool readHeader(ADS1x15_LogHeader &header)
+	{
+		position = 0;
+		if (length < ADS1x15_logHeaderSize) { return false; }
+		if (data[0] != 'A' || data[1] != 'D' || data[2] != 'S' || data[3] != 'L') { return false; }
+		if (data[4] != ADS1x15_logVersion) { return false; }
+		header.adcBits = data[5];
+		header.gain = data[6];
+		header.dataRate = data[7];
+		header.mux = data[8];
+		header.blockSamples = data[9];
+		header.calibration = (uint32_t)data[10] | ((uint32_t)data[11] << 8) |
+		                     ((uint32_t)data[12] << 16) | ((uint32_t)data[13] << 24);
+		if (header.adcBits < 2 || header.adcBits > 16) { return false; }
+		blockSamples = header.blockSamples;
+		position = ADS1x15_logHeaderSize;
+		return true;
+	}
+
+	/**
+	 * @brief Decode the next block
+	 *
+	 * @param out Codes, room for header.blockSamples entries
+	 * @return Number of codes decoded, 0 at the end of the log or on a damaged block
+	 */
+	uint8_t readBlock(int16_t *out)
+	{
+		if (position == 0 || length - position < 4) { return 0; }
+		const uint8_t *block = data + position;
+		uint8_t count = block[0];
+		uint8_t width = block[1];
+		if (count == 0 || count > blockSamples || width > ADS1x15_logMaxDeltaBits) { return 0; }
+		size_t size = 4 + ((size_t)(count - 1) * width + 7) / 8;
+		if (length - position < size) { return 0; }
+		int16_t value = (int16_t)((uint16_t)block[2] | ((uint16_t)block[3] << 8));
+		out[0] = value;
+		uint32_t bits = 0;
+		uint8_t bitCount = 0;
+		const uint8_t *packed = block + 4;
+		for (uint8_t i = 1; i < count; i++)
+		{
+			while (bitCount < width)
+			{
+				bits |= (uint32_t)*packed++ << bitCount;
+				bitCount += 8;
+			}
+			uint32_t zigzag = bits & ((1UL << width) - 1);
+			bits >>= width;
+			bitCount -= width;
+			int32_t delta = (int32_t)(zigzag >> 1) ^ -(int32_t)(zigzag & 1);
+			value = (int16_t)(value + delta);
+			out[i] = value;
+		}
+		position += size;
+		return count;
+	}
+
+private:
+	const uint8_t *data;
+	size_t length;
+	size_t position;
+	uint8_t blockSamples;
+};
+
+#endif // __ADS1x15LogFormat_h_
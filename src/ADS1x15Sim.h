@@ -0,0 +1,152 @@
+/**
+ * @file ADS1x15Sim.h
+ * @author Keegan Morrow
+ * @version 0.0.4
+ * @brief Simulated ADS1x15 chip behind the transport interface
+ */
+
+#ifndef __ADS1x15Sim_h_
+#define __ADS1x15Sim_h_
+
+#include "ADS1x15.h"
+
+/**
+ * @brief Transport that answers like one ADS1x15 chip, for running the driver without hardware
+ * @details Models the register file, the address pointer, the OS bit, single
+ * shot and continuous conversions and the conversion time for the data rate
+ * (the nominal sample period, scaled by simulatedPercent to model the
+ * oscillator error; the datasheet allows 90 to 110). The input of
+ * each MUX setting is a fixed code set with setInput(). Counts transactions
+ * and bytes on the bus, including the address byte of each transfer.
+ *
+ * Use with any ADS1x15 object: sim.address must match the address passed
+ * to begin(), and setTransport(sim) must be called before begin().
+ *
+ * @tparam Chip ADS1115_Traits or ADS1015_Traits
+ */
+template <class Chip>
+class ADS1x15_SimTransport: public ADS1x15_Transport
+{
+public:
+	ADS1x15_SimTransport()
+	{
+		address = ADS1x15_defaultAddress;
+		simulatedPercent = 100;
+		for (uint8_t i = 0; i < 8; i++) { input[i] = 0; }
+		reset();
+	}
+	/**
+	 * @brief Return the chip to its power on state and clear the counters
+	 */
+	void reset()
+	{
+		reg[CONVERSION_REG] = 0;
+		reg[CONFIG_REG] = ADS1x15_defaultConfig;
+		reg[LOW_THRESH_REG] = 0x8000;
+		reg[HI_THRESH_REG] = 0x7FFF;
+		pointer = CONVERSION_REG;
+		converting = false;
+		conversionEnd = 0;
+		transactions = 0;
+		bytes = 0;
+		conversions = 0;
+	}
+	/**
+	 * @brief Set the result returned for a MUX setting
+	 *
+	 * @param mux The configuration of the MUX
+	 * @param code Result at the chip resolution
+	 */
+	inline void setInput(ADS1x15_MUX_t mux, int16_t code) {input[(uint16_t)mux >> 12] = code;}
+	/**
+	 * @brief Get the simulated conversion time for the current data rate
+	 *
+	 * @return Conversion time in us
+	 */
+	uint32_t conversionTime()
+	{
+		typename Chip::DataRate rate = (typename Chip::DataRate)(reg[CONFIG_REG] & ADS1x15_DR_MASK);
+		return Chip::samplePeriod(rate) * simulatedPercent / 100;
+	}
+
+	bool write(uint8_t address, uint8_t r, uint16_t value, bool stop)
+	{
+		(void)stop;
+		transactions++;
+		bytes += 4;
+		if (address != this->address || r > HI_THRESH_REG) { return false; }
+		advance();
+		pointer = r;
+		if (r != CONFIG_REG)
+		{
+			reg[r] = value;
+			return true;
+		}
+		reg[CONFIG_REG] = value & ~ADS1x15_OS;
+		if ((value & ADS1x15_MODE_MASK) == (uint16_t)CONTINUOUS_CONV || (value & ADS1x15_OS))
+		{
+			converting = true;
+			conversionEnd = micros() + conversionTime();
+		}
+		else { converting = false; }
+		return true;
+	}
+	bool setPointer(uint8_t address, uint8_t r)
+	{
+		transactions++;
+		bytes += 2;
+		if (address != this->address || r > HI_THRESH_REG) { return false; }
+		pointer = r;
+		return true;
+	}
+	bool read(uint8_t address, uint16_t &value, bool stop)
+	{
+		(void)stop;
+		transactions++;
+		bytes += 3;
+		if (address != this->address) { return false; }
+		advance();
+		value = reg[pointer];
+		if (pointer == CONFIG_REG && !converting) { value |= ADS1x15_OS; }
+		return true;
+	}
+
+	uint8_t address; // hardware address the simulated chip answers on
+	uint8_t simulatedPercent; // conversion time as a percentage of the nominal sample period, above 100 for a slow chip
+	uint32_t transactions; // bus transfers since reset()
+	uint32_t bytes; // bytes on the bus since reset(), including address bytes
+	uint32_t conversions; // conversions completed since reset()
+
+private:
+	uint16_t reg[4];
+	uint8_t pointer;
+	int16_t input[8];
+	bool converting;
+	uint32_t conversionEnd;
+	/**
+	 * @brief Complete the conversions that have finished by now
+	 */
+	void advance()
+	{
+		if (!converting) { return; }
+		uint32_t now = micros();
+		if ((int32_t)(now - conversionEnd) < 0) { return; }
+		reg[CONVERSION_REG] = (uint16_t)((uint16_t)input[(reg[CONFIG_REG] & ADS1x15_MUX_MASK) >> 12] << Chip::shift());
+		if ((reg[CONFIG_REG] & ADS1x15_MODE_MASK) == (uint16_t)CONTINUOUS_CONV)
+		{
+			uint32_t period = conversionTime();
+			while ((int32_t)(now - conversionEnd) >= 0)
+			{
+				conversionEnd += period;
+				conversions++;
+			}
+		}
+		else
+		{
+			converting = false;
+			conversions++;
+		}
+	}
+};
+
+#endif // __ADS1x15Sim_h_
@@ -0,0 +1,91 @@
+#include "ADS1x15Transport.h"
+
+#ifdef ARDUINO
+
+static const uint8_t ADS1x15_hsMasterCode = 0x04; // sent as 0000 1000 by beginTransmission()
+
+ADS1x15_WireTransport ADS1x15_wireTransport(Wire);
+
+/**
+ * @brief Start the I2C bus
+ */
+void ADS1x15_WireTransport::begin()
+{
+	wire.begin();
+}
+
+/**
+ * @brief Set the bus clock
+ *
+ * @param clockHz I2C clock in Hz
+ */
+void ADS1x15_WireTransport::setClock(uint32_t clockHz)
+{
+	wire.setClock(clockHz);
+}
+
+/**
+ * @brief Send the HS-mode master code at 400 kHz and switch to the HS clock
+ *
+ * @param clockHz I2C clock in Hz
+ * @return True if HS-mode was entered
+ */
+bool ADS1x15_WireTransport::enterHighSpeed(uint32_t clockHz)
+{
+	wire.setClock(ADS1x15_fastModeClock);
+	wire.beginTransmission(ADS1x15_hsMasterCode);
+	// the master code is never acknowledged, 2 = address NACK is the expected result
+	if (wire.endTransmission(false) != 2) { return false; }
+	wire.setClock(clockHz);
+	return true;
+}
+
+/**
+ * @brief Write a 16 bit register MSB first
+ *
+ * @param address Hardware address of the chip
+ * @param reg Register pointer value
+ * @param value Value to write
+ * @param stop False to end with a repeated start instead of a STOP
+ * @return True on success
+ */
+bool ADS1x15_WireTransport::write(uint8_t address, uint8_t reg, uint16_t value, bool stop)
+{
+	wire.beginTransmission(address);
+	wire.write(reg);
+	wire.write((uint8_t)(value >> 8));
+	wire.write((uint8_t)value);
+	return wire.endTransmission(stop) == 0;
+}
+
+/**
+ * @brief Set the address pointer, ending with a repeated start
+ *
+ * @param address Hardware address of the chip
+ * @param reg Register pointer value
+ * @return True on success
+ */
+bool ADS1x15_WireTransport::setPointer(uint8_t address, uint8_t reg)
+{
+	wire.beginTransmission(address);
+	wire.write(reg);
+	return wire.endTransmission(false) == 0;
+}
+
+/**
+ * @brief Read a 16 bit register MSB first
+ *
+ * @param address Hardware address of the chip
+ * @param value Value read
+ * @param stop False to end with a repeated start instead of a STOP
+ * @return True on success
+ */
+bool ADS1x15_WireTransport::read(uint8_t address, uint16_t &value, bool stop)
+{
+	if (wire.requestFrom(address, (uint8_t)2, (uint8_t)stop) != 2) { return false; }
+	value = (uint16_t)wire.read() << 8;
+	value |= (uint8_t)wire.read();
+	return true;
+}
+
+#endif // ARDUINO
@@ -0,0 +1,128 @@
+/**
+ * @file ADS1x15Transport.h
+ * @author Keegan Morrow
+ * @version 0.0.4
+ * @brief Bus access used by the ADS1x15 classes
+ */
+
+#ifndef __ADS1x15Transport_h_
+#define __ADS1x15Transport_h_
+
+#include "ADS1x15Lock.h"
+
+static const uint32_t ADS1x15_fastModeClock = 400000UL; // highest clock before HS-mode entry is needed
+static const uint32_t ADS1x15_fastModePlusClock = 1000000UL;
+
+/**
+ * @brief Interface to the I2C bus for the ADS1x15 classes
+ * @details 16 bit register values are passed in host byte order; the chip
+ * sends and expects them MSB first. An implementation may complete readAsync()
+ * in the background (DMA, interrupt driven I2C), in which case busy() stays
+ * true until the destination has been written. The default readAsync() is
+ * synchronous.
+ */
+class ADS1x15_Transport
+{
+public:
+	ADS1x15_Transport(): busLock(NULL) {}
+	/**
+	 * @brief Set a lock held for each transfer on this bus
+	 *
+	 * @param lock Lock to use, NULL for none
+	 */
+	inline void setLock(ADS1x15_Lock *lock) {busLock = lock;}
+	/**
+	 * @brief Get the lock set with setLock()
+	 *
+	 * @return Lock, NULL for none
+	 */
+	inline ADS1x15_Lock *getLock() {return busLock;}
+	/**
+	 * @brief Prepare the bus for use
+	 */
+	virtual void begin() {}
+	/**
+	 * @brief Set the bus clock
+	 *
+	 * @param clockHz I2C clock in Hz
+	 */
+	virtual void setClock(uint32_t clockHz) {(void)clockHz;}
+	/**
+	 * @brief Send the HS-mode master code at F/S speed and switch to the HS clock
+	 *
+	 * @param clockHz I2C clock in Hz
+	 * @return True if HS-mode was entered
+	 */
+	virtual bool enterHighSpeed(uint32_t clockHz) {(void)clockHz; return false;}
+	/**
+	 * @brief Write a 16 bit register
+	 *
+	 * @param address Hardware address of the chip
+	 * @param reg Register pointer value
+	 * @param value Value to write
+	 * @param stop False to end with a repeated start instead of a STOP
+	 * @return True on success
+	 */
+	virtual bool write(uint8_t address, uint8_t reg, uint16_t value, bool stop) = 0;
+	/**
+	 * @brief Set the address pointer, to be followed by a read with a repeated start
+	 *
+	 * @param address Hardware address of the chip
+	 * @param reg Register pointer value
+	 * @return True on success
+	 */
+	virtual bool setPointer(uint8_t address, uint8_t reg) = 0;
+	/**
+	 * @brief Read the 16 bit register at the current address pointer
+	 *
+	 * @param address Hardware address of the chip
+	 * @param value Value read
+	 * @param stop False to end with a repeated start instead of a STOP
+	 * @return True on success
+	 */
+	virtual bool read(uint8_t address, uint16_t &value, bool stop) = 0;
+	/**
+	 * @brief Start reading the 16 bit register at the current address pointer
+	 *
+	 * @param address Hardware address of the chip
+	 * @param value Destination, valid once busy() returns false
+	 * @param stop False to end with a repeated start instead of a STOP
+	 * @return True if the transfer was started (or completed)
+	 */
+	virtual bool readAsync(uint8_t address, uint16_t *value, bool stop) {return read(address, *value, stop);}
+	/**
+	 * @brief Check if a transfer started by readAsync() is still running
+	 *
+	 * @return True while the transfer is in progress
+	 */
+	virtual bool busy() {return false;}
+
+protected:
+	ADS1x15_Lock *busLock;
+};
+
+#ifdef ARDUINO
+#include <Wire.h>
+
+/**
+ * @brief Transport using an Arduino TwoWire instance
+ */
+class ADS1x15_WireTransport: public ADS1x15_Transport
+{
+public:
+	ADS1x15_WireTransport(TwoWire &wire): wire(wire) {}
+	void begin();
+	void setClock(uint32_t);
+	bool enterHighSpeed(uint32_t);
+	bool write(uint8_t, uint8_t, uint16_t, bool);
+	bool setPointer(uint8_t, uint8_t);
+	bool read(uint8_t, uint16_t &, bool);
+
+private:
+	TwoWire &wire;
+};
+
+extern ADS1x15_WireTransport ADS1x15_wireTransport; // default transport on Wire
+#endif // ARDUINO
+
+#endif // __ADS1x15Transport_h_